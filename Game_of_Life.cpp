@@ -7,6 +7,7 @@
  * @date March, 2020
  */
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 
@@ -14,6 +15,8 @@
 #include "cxxopts/cxxopts.hxx"
 
 #include "grid.h"
+#include "rule.h"
+#include "terminal_view.h"
 #include "world.h"
 #include "zoo.h"
 
@@ -24,11 +27,30 @@ int main(int argc, char *argv[]) {
 
     // Declare the valid command line arguments and their types and default values.
     options.add_options()
-            ("f,file", "Load an ascii file from the provided path.",  cxxopts::value<std::string>())
-            ("o,output", "Save an ascii file to the provided path.",  cxxopts::value<std::string>())
+            ("f,file", "Load a file from the provided path. The format is picked by extension: .rle, .bgol, or ascii otherwise.",
+                cxxopts::value<std::string>())
+            ("o,output", "Save a file to the provided path. The format is picked by extension: .rle, .bgol, or ascii otherwise."
+                " A .bgol file is written as a compressed snapshot holding the rule and generation.",
+                cxxopts::value<std::string>())
             ("s,steps","The number of steps to simulate the world.", cxxopts::value<int>()->default_value("10"))
             ("e,every","Print world to the console every N steps. 0 disables printing.", cxxopts::value<int>()->default_value("0"))
+            ("l,live", "Redraw the world in place every N steps (see --every, default 1), writing only the cells that changed."
+                " The view is clipped to the terminal and drawn at most 30 times a second.", cxxopts::value<bool>()->default_value("false"))
+            ("b,braille", "With --live, draw each 2x4 block of cells as one braille character.", cxxopts::value<bool>()->default_value("false"))
             ("t,toroidal", "Simulate the Game of Life on a torus.", cxxopts::value<bool>()->default_value("false"))
+            ("j,threads", "The number of threads used to step the world.", cxxopts::value<int>()->default_value("1"))
+            ("N,numa", "Pin the threads to the memory nodes of the machine and keep the rows each steps on its node,"
+                " reporting the throughput of each node. Needs more than one thread and memory node.", cxxopts::value<bool>()->default_value("false"))
+            ("E,engine", "The stepping engine to use: scalar, packed, simd, hashlife, or sparse."
+                " HashLife and sparse simulate an unbounded plane viewed through the grid.", cxxopts::value<std::string>()->default_value("scalar"))
+            ("T,tiles", "Skip 64x64 tiles that are stable, reporting the active tiles. Requires the packed engine.",
+                cxxopts::value<bool>()->default_value("false"))
+            ("k,block", "Advance the packed engine this many generations per pass over memory, for boards much larger than the cache."
+                " Ignored with --tiles or --cycles.", cxxopts::value<int>()->default_value("1"))
+            ("m,memory", "The memory limit in MiB for the HashLife node cache.", cxxopts::value<int>()->default_value("1024"))
+            ("c,cycles", "Detect still lifes and oscillators up to this period, skipping the rest of the steps once found. 0 disables.",
+                cxxopts::value<int>()->default_value("0"))
+            ("r,rule", "The life-like rule in B/S notation, i.e. B36/S23 for HighLife.", cxxopts::value<std::string>()->default_value("B3/S23"))
             ("h,help", "Print usage.");
 
     // Actually parse the command line arguments
@@ -42,16 +64,50 @@ int main(int argc, char *argv[]) {
 
     // Parse the (potentially defaulted) parameters for this simulation
     const int  steps    = result["steps"].as<int>();
-    const int  every    = result["every"].as<int>();
+    const bool live     = result["live"].as<bool>();
+    const bool braille  = result["braille"].as<bool>();
+    const int  every    = (live && result["every"].as<int>() == 0) ? 1 : result["every"].as<int>();
     const bool toroidal = result["toroidal"].as<bool>();
+    const std::string engine = result["engine"].as<std::string>();
+    const int  threads  = result["threads"].as<int>();
+    const bool numa     = result["numa"].as<bool>();
+    const int  memory   = result["memory"].as<int>();
+    const bool tiles    = result["tiles"].as<bool>();
+    const int  block    = result["block"].as<int>();
+    const int  cycles   = result["cycles"].as<int>();
 
-    // Start with an empty grid
+    // Start with an empty grid, and the rule given on the command line
     Grid grid;
+    std::string rulestring = result["rule"].as<std::string>();
 
-    // Attempt to read in and parse the input file as an ascii .gol file if a path was given
+    // Tests whether a path ends with the given extension
+    auto has_extension = [](const std::string &path, const std::string &extension) {
+        return path.size() >= extension.size()
+            && path.compare(path.size() - extension.size(), extension.size(), extension) == 0;
+    };
+
+    // Attempt to read in and parse the input file if a path was given,
+    // an .rle or .bgol file also supplies its rule unless one was given on the command line,
+    // and a .bgol snapshot the generation it was saved at
+    long long generation = 0;
     if (result.count("file")) {
+        const std::string path = result["file"].as<std::string>();
         try {
-            grid = Zoo::load_ascii(result["file"].as<std::string>());
+            if (has_extension(path, ".rle")) {
+                Rule file_rule;
+                grid = Zoo::load_rle(path, file_rule);
+                if (!result.count("rule")) {
+                    rulestring = file_rule.to_string();
+                }
+            } else if (has_extension(path, ".bgol")) {
+                Rule file_rule;
+                grid = Zoo::load_binary(path, file_rule, generation);
+                if (!result.count("rule")) {
+                    rulestring = file_rule.to_string();
+                }
+            } else {
+                grid = Zoo::load_ascii(path);
+            }
         }
         catch (const std::exception &ex) {
             std::cerr << ex.what() << std::endl;
@@ -62,31 +118,134 @@ int main(int argc, char *argv[]) {
     // Construct a world from the parsed grid
     World world(grid);
 
+    // Parse the rule, unbounded engines cannot simulate births on 0 neighbours
+    try {
+        Rule rule(rulestring);
+        if ((rule.get_birth() & 1) && (engine == "hashlife" || engine == "sparse")) {
+            std::cerr << "The " << engine << " engine does not support rules with B0" << std::endl;
+            std::exit(-1);
+        }
+        world.set_rule(rule);
+    }
+    catch (const std::exception &ex) {
+        std::cerr << ex.what() << std::endl;
+        std::exit(-1);
+    }
+
+    // Select the stepping engine
+    if (engine == "scalar") {
+        world.set_engine(Engine::SCALAR);
+    } else if (engine == "packed") {
+        world.set_engine(Engine::PACKED);
+    } else if (engine == "simd") {
+        world.set_engine(Engine::SIMD);
+    } else if (engine == "hashlife" && !toroidal) {
+        world.set_engine(Engine::HASHLIFE);
+        world.set_hashlife_memory(static_cast<std::size_t>(memory) << 20);
+    } else if (engine == "sparse" && !toroidal) {
+        world.set_engine(Engine::SPARSE);
+    } else if (engine == "hashlife" || engine == "sparse") {
+        std::cerr << "The " << engine << " engine does not support toroidal worlds" << std::endl;
+        std::exit(-1);
+    } else {
+        std::cerr << "Unknown engine: " << engine << std::endl;
+        std::exit(-1);
+    }
+    world.set_threads(threads);
+    world.set_numa(numa);
+    world.set_tile_tracking(tiles);
+    world.set_temporal_blocking(block);
+    if (cycles > 0) {
+        if (engine == "hashlife" || engine == "sparse") {
+            std::cerr << "Cycle detection is not supported by the " << engine << " engine" << std::endl;
+            std::exit(-1);
+        }
+        world.set_cycle_detection(cycles);
+    }
+
+    // In live mode the world is redrawn in place instead of printed, with a status line beneath
+    TerminalView view(std::cout, braille);
+    view.set_frame_rate(30);
+    auto status = [&](int step) {
+        return "Step " + std::to_string(step) + " of " + std::to_string(steps)
+             + " | Alive " + std::to_string(world.get_alive_cells());
+    };
+
     // Print the initial state of the grid
-    std::cout << "Initial state..." << std::endl
-              << "Alive " << world.get_alive_cells() << " | Dead " << world.get_dead_cells()  << std::endl
-              << world.get_state() << std::endl;
-
-    // Perform the requested number of update steps
-    for (int step = 0; step < steps; step++) {
-        world.step(toroidal);
-
-        // Print the state of the grid every N steps
-        if ((every > 0) && (step % every == 0)) {
-            std::cout << "Step " << (step + 1) << " of " << steps << std::endl
-                      << world.get_state() << std::endl;
+    if (live) {
+        view.draw(world.get_state(), status(0));
+    } else {
+        std::cout << "Initial state..." << std::endl
+                  << "Alive " << world.get_alive_cells() << " | Dead " << world.get_dead_cells()  << std::endl
+                  << world.get_state() << std::endl;
+    }
+
+    // Perform the requested number of update steps, advancing in chunks between each printed step
+    // so engines that work on their own copy of the state only convert it when it is needed
+    for (int step = 0; step < steps; ) {
+        int chunk = steps - step;
+        if (every > 0) {
+            chunk = std::min(chunk, (step == 0) ? 1 : every);
+        }
+        world.advance(chunk, toroidal);
+        step += chunk;
+
+        // Print the state of the grid every N steps, or redraw it if a frame is due
+        if (live) {
+            if (view.is_due()) {
+                view.draw(world.get_state(), status(step));
+            }
+        } else if ((every > 0) && ((step - 1) % every == 0)) {
+            std::cout << "Step " << step << " of " << steps << std::endl;
+            if (tiles) {
+                std::cout << "Active tiles " << world.get_active_tiles() << " of " << world.get_total_tiles() << std::endl;
+            }
+            std::cout << world.get_state() << std::endl;
         }
     }
 
-    // Print the final state of the grid
+    // Print the final state of the grid, the grid itself already being on screen in live mode
+    if (live) {
+        view.draw(world.get_state(), status(steps));
+        view.close();
+    }
     std::cout << "Final state..." << std::endl
-              << "Alive " << world.get_alive_cells() << " | Dead " << world.get_dead_cells()  << std::endl
-              << world.get_state() << std::endl;
+              << "Alive " << world.get_alive_cells() << " | Dead " << world.get_dead_cells()  << std::endl;
+    if (tiles) {
+        std::cout << "Active tiles " << world.get_active_tiles() << " of " << world.get_total_tiles() << std::endl;
+    }
+    const ThreadPool::Stats thread_stats = world.get_thread_stats();
+    for (std::size_t i = 0; i < thread_stats.threads.size(); i++) {
+        const ThreadPool::ThreadStats &thread = thread_stats.threads[i];
+        std::cout << "Thread " << i << " | Tasks " << thread.tasks << " | Steals " << thread.steals
+                  << " | Busy " << thread.busy.count() / 1000000 << " ms" << std::endl;
+    }
+    for (const Numa::NodeStats &node : world.get_node_stats()) {
+        const double seconds = node.busy.count() / 1e9;
+        std::cout << "Node " << node.node << " | Threads " << node.threads << " | Tasks " << node.tasks
+                  << " | Busy " << node.busy.count() / 1000000 << " ms"
+                  << " | " << static_cast<long long>(seconds > 0 ? node.items / seconds : 0) << " items/s" << std::endl;
+    }
+    if (world.get_cycle_period() == 1) {
+        std::cout << "Still life from step " << world.get_cycle_start() << std::endl;
+    } else if (world.get_cycle_period() > 1) {
+        std::cout << "Period " << world.get_cycle_period() << " oscillator from step " << world.get_cycle_start() << std::endl;
+    }
+    if (!live) {
+        std::cout << world.get_state() << std::endl;
+    }
 
     // Attempt to save to the output directory if a path was given
     if (result.count("output")) {
         try {
-            Zoo::save_ascii(result["output"].as<std::string>(), world.get_state());
+            const std::string path = result["output"].as<std::string>();
+            if (has_extension(path, ".rle")) {
+                Zoo::save_rle(path, world.get_state(), world.get_rule());
+            } else if (has_extension(path, ".bgol")) {
+                Zoo::save_snapshot(path, world.get_state(), world.get_rule(), generation + world.get_generation());
+            } else {
+                Zoo::save_ascii(path, world.get_state());
+            }
         }
         catch (const std::exception &ex) {
             std::cerr << ex.what() << std::endl;
@@ -0,0 +1,484 @@
+/**
+ * Implements a class representing a bit-packed 2d grid of cells.
+ *      - Cells are stored one bit per cell in 64 bit words, using 1/8th of the memory of a Grid.
+ *      - New cells are initialized to Cell::DEAD.
+ *      - BitGrids can be converted to and from a Grid.
+ *      - BitGrids can return counts of the alive and dead cells, a whole word at a time.
+ *      - BitGrids expose each row as a contiguous run of words for word-parallel algorithms.
+ *
+ * @author 959133
+ * @date March, 2020
+ */
+
+#include "bitgrid.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+/**
+ * BitGrid::Reference::Reference(word, mask)
+ *
+ * Construct a reference to the bit(s) selected by mask within word.
+ *
+ * @param word
+ *      The word holding the referenced cell.
+ *
+ * @param mask
+ *      A mask with a single bit set selecting the referenced cell.
+ */
+BitGrid::Reference::Reference(std::uint64_t &word, std::uint64_t mask) : word(word), mask(mask) {
+}
+
+/**
+ * BitGrid::Reference::operator Cell()
+ *
+ * Reads the referenced cell.
+ *
+ * @return
+ *      Cell::ALIVE if the referenced bit is set, otherwise Cell::DEAD.
+ */
+BitGrid::Reference::operator Cell() const {
+    return (word & mask) ? Cell::ALIVE : Cell::DEAD;
+}
+
+/**
+ * BitGrid::Reference::operator=(value)
+ *
+ * Overwrites the referenced cell.
+ *
+ * @param value
+ *      The value to be written to the referenced cell.
+ *
+ * @return
+ *      A reference to this reference to enable assignment chaining.
+ */
+BitGrid::Reference& BitGrid::Reference::operator=(Cell value) {
+    if (value == Cell::ALIVE) {
+        word |= mask;
+    } else {
+        word &= ~mask;
+    }
+    return *this;
+}
+
+/**
+ * BitGrid::Reference::operator=(other)
+ *
+ * Copies the value of another referenced cell into the referenced cell.
+ *
+ * @param other
+ *      The reference to read the value from.
+ *
+ * @return
+ *      A reference to this reference to enable assignment chaining.
+ */
+BitGrid::Reference& BitGrid::Reference::operator=(const Reference &other) {
+    return operator=(static_cast<Cell>(other));
+}
+
+/**
+ * BitGrid::BitGrid()
+ *
+ * Construct an empty bit grid of size 0x0.
+ *
+ * @example
+ *
+ *      // Make a 0x0 empty bit grid
+ *      BitGrid grid;
+ *
+ */
+BitGrid::BitGrid() : BitGrid(0, 0) {
+}
+
+/**
+ * BitGrid::BitGrid(square_size)
+ *
+ * Construct a bit grid with the desired size filled with dead cells.
+ *
+ * @example
+ *
+ *      // Make a 16x16 bit grid
+ *      BitGrid grid(16);
+ *
+ * @param square_size
+ *      The edge size to use for the width and height of the grid.
+ */
+BitGrid::BitGrid(int square_size) : BitGrid(square_size, square_size) {
+}
+
+/**
+ * BitGrid::BitGrid(width, height)
+ *
+ * Construct a bit grid with the desired size filled with dead cells.
+ *
+ * @example
+ *
+ *      // Make a 16x9 bit grid
+ *      BitGrid grid(16, 9);
+ *
+ * @param width
+ *      The width of the grid.
+ *
+ * @param height
+ *      The height of the grid.
+ *
+ * @throws
+ *      std::runtime_error or sub-class if the width or height is negative.
+ */
+BitGrid::BitGrid(int width, int height) {
+    if (width < 0 || height < 0) {
+        throw std::runtime_error("Incorrect height or width.");
+    }
+    this->width = width;
+    this->height = height;
+    this->words_per_row = (width + 63) / 64;
+
+    words.resize(static_cast<std::size_t>(words_per_row) * height, 0);
+}
+
+/**
+ * BitGrid::BitGrid(grid)
+ *
+ * Construct a bit grid holding the same size and contents as a Grid.
+ *
+ * @example
+ *
+ *      // Pack a glider into one bit per cell
+ *      BitGrid packed(Zoo::glider());
+ *
+ * @param grid
+ *      The grid to copy the size and contents from.
+ */
+BitGrid::BitGrid(const Grid &grid) : BitGrid(grid.get_width(), grid.get_height()) {
+    for (int y = 0; y < height; y++) {
+        const Cell *cells = grid.grid.data() + static_cast<std::size_t>(y) * width;
+        std::uint64_t *out = row(y);
+        for (int w = 0; w < words_per_row; w++) {
+            int x0 = w * 64;
+            int bits = std::min(64, width - x0);
+            std::uint64_t word = 0;
+            for (int b = 0; b < bits; b++) {
+                word |= static_cast<std::uint64_t>(cells[x0 + b] == Cell::ALIVE) << b;
+            }
+            out[w] = word;
+        }
+    }
+}
+
+/**
+ * BitGrid::get_width()
+ *
+ * Gets the current width of the bit grid.
+ *
+ * @return
+ *      The width of the grid.
+ */
+int BitGrid::get_width() const {
+    return this->width;
+}
+
+/**
+ * BitGrid::get_height()
+ *
+ * Gets the current height of the bit grid.
+ *
+ * @return
+ *      The height of the grid.
+ */
+int BitGrid::get_height() const {
+    return this->height;
+}
+
+/**
+ * BitGrid::get_total_cells()
+ *
+ * Gets the total number of cells in the bit grid.
+ *
+ * @return
+ *      The number of total cells.
+ */
+long long BitGrid::get_total_cells() const {
+    return static_cast<long long>(this->width) * this->height;
+}
+
+/**
+ * BitGrid::get_alive_cells()
+ *
+ * Counts how many cells in the bit grid are alive.
+ * Counts a whole word of 64 cells at a time, relying on the padding bits always being 0.
+ *
+ * @return
+ *      The number of alive cells.
+ */
+long long BitGrid::get_alive_cells() const {
+    long long alive = 0;
+    for (auto it = std::begin(words); it != std::end(words); it++) {
+        alive += popcount64(*it);
+    }
+    return alive;
+}
+
+/**
+ * BitGrid::get_dead_cells()
+ *
+ * Counts how many cells in the bit grid are dead.
+ *
+ * @return
+ *      The number of dead cells.
+ */
+long long BitGrid::get_dead_cells() const {
+    return get_total_cells() - get_alive_cells();
+}
+
+/**
+ * BitGrid::get_words_per_row()
+ *
+ * Gets the number of 64 bit words used to store each row.
+ *
+ * @return
+ *      The row stride in words.
+ */
+int BitGrid::get_words_per_row() const {
+    return this->words_per_row;
+}
+
+/**
+ * BitGrid::get_tail_mask()
+ *
+ * Gets a mask of the bits in the last word of each row that hold real cells.
+ * Word-parallel algorithms should and their final word of each row with this mask
+ * to keep the padding bits at 0.
+ *
+ * @return
+ *      The mask of valid bits in the last word of a row.
+ */
+std::uint64_t BitGrid::get_tail_mask() const {
+    int bits = width % 64;
+    return bits == 0 ? ~std::uint64_t(0) : (std::uint64_t(1) << bits) - 1;
+}
+
+/**
+ * BitGrid::check(x, y)
+ *
+ * Private helper function to validate a coordinate.
+ *
+ * @throws
+ *      std::runtime_error or sub-class if x,y is not a valid coordinate within the grid.
+ */
+void BitGrid::check(int x, int y) const {
+    if (x >= width || x < 0 || y >= height || y < 0) {
+        throw std::runtime_error("Coordinates out of scope");
+    }
+}
+
+/**
+ * BitGrid::get(x, y)
+ *
+ * Returns the value of the cell at the desired coordinate.
+ *
+ * @example
+ *
+ *      // Make a bit grid
+ *      BitGrid grid(4, 4);
+ *
+ *      // Read the cell at coordinate (1, 2)
+ *      Cell cell = grid.get(1, 2);
+ *
+ * @param x
+ *      The x coordinate of the cell to read.
+ *
+ * @param y
+ *      The y coordinate of the cell to read.
+ *
+ * @return
+ *      The value of the desired cell. Should only be Grid::ALIVE or Grid::DEAD.
+ *
+ * @throws
+ *      std::runtime_error or sub-class if x,y is not a valid coordinate within the grid.
+ */
+Cell BitGrid::get(int x, int y) const {
+    return operator()(x, y);
+}
+
+/**
+ * BitGrid::set(x, y, value)
+ *
+ * Overwrites the value at the desired coordinate.
+ *
+ * @example
+ *
+ *      // Make a bit grid
+ *      BitGrid grid(4, 4);
+ *
+ *      // Assign to a cell at coordinate (1, 2)
+ *      grid.set(1, 2, Cell::ALIVE);
+ *
+ * @param x
+ *      The x coordinate of the cell to update.
+ *
+ * @param y
+ *      The y coordinate of the cell to update.
+ *
+ * @param value
+ *      The value to be written to the selected cell.
+ *
+ * @throws
+ *      std::runtime_error or sub-class if x,y is not a valid coordinate within the grid.
+ */
+void BitGrid::set(int x, int y, Cell value) {
+    operator()(x, y) = value;
+}
+
+/**
+ * BitGrid::clear()
+ *
+ * Sets every cell in the bit grid to Cell::DEAD.
+ */
+void BitGrid::clear() {
+    std::fill(words.begin(), words.end(), 0);
+}
+
+/**
+ * BitGrid::row(y)
+ *
+ * Gets the words storing row y, without checking y is within the grid.
+ * The row is BitGrid::get_words_per_row() words long.
+ *
+ * @param y
+ *      The y coordinate of the row.
+ *
+ * @return
+ *      A pointer to the first word of the row.
+ */
+std::uint64_t* BitGrid::row(int y) {
+    return words.data() + static_cast<std::size_t>(y) * words_per_row;
+}
+
+/**
+ * BitGrid::row(y)
+ *
+ * Gets the words storing row y, without checking y is within the grid.
+ * The function should be callable from a constant context.
+ *
+ * @param y
+ *      The y coordinate of the row.
+ *
+ * @return
+ *      A read-only pointer to the first word of the row.
+ */
+const std::uint64_t* BitGrid::row(int y) const {
+    return words.data() + static_cast<std::size_t>(y) * words_per_row;
+}
+
+/**
+ * BitGrid::to_grid()
+ *
+ * Unpacks the bit grid into a Grid of the same size and contents.
+ *
+ * @example
+ *
+ *      // Print a bit grid using the Grid serializer
+ *      std::cout << packed.to_grid() << std::endl;
+ *
+ * @return
+ *      A new grid containing the values of the bit grid.
+ */
+Grid BitGrid::to_grid() const {
+    Grid grid(width, height);
+    to_grid(grid, 0, height);
+    return grid;
+}
+
+/**
+ * BitGrid::to_grid(grid, y0, y1)
+ *
+ * Unpacks the rows [y0, y1) of the bit grid into an existing Grid of the same size, reusing its memory.
+ * Different rows can be unpacked at the same time from different threads.
+ *
+ * @example
+ *
+ *      // Copy the bit grid back into the grid it was packed from
+ *      BitGrid packed(grid);
+ *      packed.to_grid(grid, 0, grid.get_height());
+ *
+ * @param grid
+ *      The grid to write the rows into.
+ *
+ * @param y0
+ *      The first row to unpack.
+ *
+ * @param y1
+ *      One past the last row to unpack.
+ *
+ * @throws
+ *      std::runtime_error or sub-class if the grid is a different size to the bit grid, or the rows are out of bounds.
+ */
+void BitGrid::to_grid(Grid &grid, int y0, int y1) const {
+    if (grid.get_width() != width || grid.get_height() != height) {
+        throw std::runtime_error("The grid is a different size to the bit grid");
+    }
+    if (y0 < 0 || y1 > height) {
+        throw std::runtime_error("The rows are outside the bit grid");
+    }
+    for (int y = y0; y < y1; y++) {
+        Cell *cells = grid.grid.data() + static_cast<std::size_t>(y) * width;
+        const std::uint64_t *in = row(y);
+        for (int x = 0; x < width; x++) {
+            cells[x] = ((in[x / 64] >> (x % 64)) & 1) ? Cell::ALIVE : Cell::DEAD;
+        }
+    }
+}
+
+/**
+ * BitGrid::operator()(x, y)
+ *
+ * Gets a modifiable reference to the value at the desired coordinate.
+ * As cells are single bits the reference is a BitGrid::Reference proxy which converts to and from a Cell.
+ *
+ * @example
+ *
+ *      // Make a bit grid
+ *      BitGrid grid(4, 4);
+ *
+ *      // Directly assign to a cell at coordinate (1, 2)
+ *      grid(1, 2) = Cell::ALIVE;
+ *
+ * @param x
+ *      The x coordinate of the cell to access.
+ *
+ * @param y
+ *      The y coordinate of the cell to access.
+ *
+ * @return
+ *      A modifiable reference to the desired cell.
+ *
+ * @throws
+ *      std::runtime_error or sub-class if x,y is not a valid coordinate within the grid.
+ */
+BitGrid::Reference BitGrid::operator()(int x, int y) {
+    check(x, y);
+    return Reference(row(y)[x / 64], std::uint64_t(1) << (x % 64));
+}
+
+/**
+ * BitGrid::operator()(x, y)
+ *
+ * Gets the value at the desired coordinate.
+ * The operator should be callable from a constant context.
+ *
+ * @param x
+ *      The x coordinate of the cell to access.
+ *
+ * @param y
+ *      The y coordinate of the cell to access.
+ *
+ * @return
+ *      The value of the desired cell.
+ *
+ * @throws
+ *      std::runtime_error or sub-class if x,y is not a valid coordinate within the grid.
+ */
+Cell BitGrid::operator()(int x, int y) const {
+    check(x, y);
+    return ((row(y)[x / 64] >> (x % 64)) & 1) ? Cell::ALIVE : Cell::DEAD;
+}
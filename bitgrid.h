@@ -0,0 +1,86 @@
+/**
+ * Declares a class representing a bit-packed 2d grid of cells.
+ * Rich documentation for the api and behaviour the BitGrid class can be found in bitgrid.cpp.
+ *
+ * @author 959133
+ * @date March, 2020
+ */
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "grid.h"
+
+/**
+ * Counts the set bits in a 64 bit word.
+ */
+inline int popcount64(std::uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(word);
+#else
+    int count = 0;
+    for (; word; word &= word - 1) {
+        count++;
+    }
+    return count;
+#endif
+}
+
+/**
+ * Declare the structure of the BitGrid class for representing a 2d grid of cells with one bit per cell.
+ *
+ * Each row starts on a fresh 64 bit word so that a row can be processed a whole word at a time.
+ *      - Cell x of row y lives in bit (x % 64) of word (x / 64) of that row.
+ *      - Padding bits past the width of the grid in the last word of a row are always 0.
+ */
+class BitGrid {
+private:
+    int width;
+    int height;
+    int words_per_row;
+    std::vector<std::uint64_t> words;
+
+    void check(int x, int y) const;
+
+public:
+
+    /**
+     * A modifiable reference to a single bit, returned by BitGrid::operator()(x, y).
+     */
+    class Reference {
+    private:
+        std::uint64_t &word;
+        std::uint64_t mask;
+
+    public:
+        Reference(std::uint64_t &word, std::uint64_t mask);
+        operator Cell() const;
+        Reference& operator=(Cell value);
+        Reference& operator=(const Reference &other);
+    };
+
+    BitGrid();
+    explicit BitGrid(int square_size);
+    BitGrid(int width, int height);
+    explicit BitGrid(const Grid &grid);
+
+    int get_width() const;
+    int get_height() const;
+    long long get_total_cells() const;
+    long long get_alive_cells() const;
+    long long get_dead_cells() const;
+    int get_words_per_row() const;
+    std::uint64_t get_tail_mask() const;
+
+    Cell get(int x, int y) const;
+    void set(int x, int y, Cell value);
+    void clear();
+
+    std::uint64_t* row(int y);
+    const std::uint64_t* row(int y) const;
+
+    Grid to_grid() const;
+    void to_grid(Grid &grid, int y0, int y1) const;
+
+    Reference operator()(int x, int y);
+    Cell operator()(int x, int y) const;
+};
@@ -0,0 +1,337 @@
+/**
+ * Benchmarks for the Game of Life hot paths.
+ *
+ * Build alongside the library sources, i.e.
+ * g++ -O2 -std=c++11 -pthread gol_bench.cpp grid.cpp world.cpp zoo.cpp bitgrid.cpp simd.cpp thread_pool.cpp \
+ *     hashlife.cpp sparse_world.cpp rule.cpp mapped_file.cpp numa.cpp -o gol_bench
+ *
+ * Run with a list of square grid sizes, defaulting to 256 1024 4096, and any of the options:
+ *      --filter TEXT       Only run the benchmarks whose name contains TEXT.
+ *      --min-time SECONDS  Repeat each benchmark for at least this long, defaulting to 0.25.
+ *      --json PATH         Also write the results to PATH as JSON.
+ *      --baseline PATH     Compare against the JSON results of an earlier run, exiting with 1 if any
+ *                          benchmark is slower than it by more than the tolerance.
+ *      --tolerance RATIO   The slowdown allowed against the baseline, defaulting to 0.1 for 10%.
+ * i.e.
+ * ./gol_bench 1024 4096 --filter world_step --json new.json --baseline old.json
+ *
+ * Every benchmark is reported as the time per operation, the cells processed per second,
+ * and for stepping benchmarks the generations per second. The JSON output holds one result per line:
+ *
+ *      {"suite": "gol_bench", "results": [
+ *        {"name": "world_step/packed/bounded/1024/0.30", "size": 1024, "density": 0.30,
+ *         "seconds_per_op": 0.0004, "cells_per_second": 2.6e+09, "generations_per_second": 2500},
+ *        ...
+ *      ]}
+ *
+ * @author 959133
+ * @date March, 2020
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "grid.h"
+#include "world.h"
+#include "zoo.h"
+
+/**
+ * Times the average cost of calling body(), repeating it until at least min_seconds have passed.
+ *
+ * @return
+ *      The average time per call in seconds.
+ */
+template <typename Body>
+static double time_per_call(Body body, double min_seconds = 0.25) {
+    using Clock = std::chrono::steady_clock;
+    long long calls = 0;
+    auto start = Clock::now();
+    double elapsed = 0;
+    do {
+        body();
+        calls++;
+        elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    } while (elapsed < min_seconds);
+    return elapsed / calls;
+}
+
+/**
+ * Makes a square grid where each cell is alive with the given probability, the same for every run.
+ */
+static Grid random_grid(int size, double density) {
+    Grid grid(size);
+    std::mt19937 random(12345);
+    std::bernoulli_distribution alive(density);
+    for (Cell &cell : grid.grid) {
+        cell = alive(random) ? Cell::ALIVE : Cell::DEAD;
+    }
+    return grid;
+}
+
+/**
+ * The measurements of a single benchmark.
+ */
+struct Result {
+    std::string name;
+    int size;
+    double density;
+    double seconds_per_op;
+    double cells_per_second;
+    double generations_per_second;
+};
+
+/**
+ * Runs the benchmarks that pass the filter, printing each result as it is measured.
+ */
+class Suite {
+private:
+    std::string filter;
+    double min_seconds;
+
+public:
+    std::vector<Result> results;
+
+    Suite(const std::string &filter, double min_seconds) : filter(filter), min_seconds(min_seconds) {
+    }
+
+    // Tests whether a benchmark is selected, so its setup can be skipped when it is not
+    bool wants(const std::string &name) const {
+        return name.find(filter) != std::string::npos;
+    }
+
+    // Times body, which processes cells cells over generations generations per call
+    void run(const std::string &name, int size, double density, double cells, double generations,
+             const std::function<void()> &body) {
+        if (!wants(name)) {
+            return;
+        }
+        const double seconds = time_per_call(body, min_seconds);
+        Result result = {name, size, density, seconds, cells / seconds, generations / seconds};
+        results.push_back(result);
+
+        std::cout << std::left << std::setw(44) << name << std::right
+                  << std::setw(14) << std::fixed << std::setprecision(3) << seconds * 1e3 << " ms"
+                  << std::setw(14) << std::setprecision(1) << result.cells_per_second / 1e6 << " Mcell/s";
+        if (generations > 0) {
+            std::cout << std::setw(14) << std::setprecision(1) << result.generations_per_second << " gen/s";
+        }
+        std::cout << std::endl;
+    }
+};
+
+/**
+ * Compares the cost of ending a step by copying the next state grid into the current state grid,
+ * as World::step used to, against swapping the two buffers.
+ */
+static void bench_buffer_exchange(Suite &suite, int size) {
+    Grid current(size), next(size);
+    next(size / 2, size / 2) = Cell::ALIVE;
+    const double cells = static_cast<double>(size) * size;
+
+    suite.run("buffer/copy/" + std::to_string(size), size, 0, cells, 0, [&] { current = next; });
+    suite.run("buffer/swap/" + std::to_string(size), size, 0, cells, 0, [&] { std::swap(current, next); });
+}
+
+/**
+ * Times World::step for each dense engine, on bounded and toroidal worlds of random soups of the given density.
+ */
+static void bench_world_step(Suite &suite, int size, double density) {
+    static const std::pair<const char*, Engine> engines[] = {
+        {"scalar", Engine::SCALAR}, {"packed", Engine::PACKED}, {"simd", Engine::SIMD}
+    };
+    std::ostringstream suffix;
+    suffix << size << "/" << std::fixed << std::setprecision(2) << density;
+    const double cells = static_cast<double>(size) * size;
+
+    for (const auto &engine : engines) {
+        for (bool toroidal : {false, true}) {
+            const std::string name = std::string("world_step/") + engine.first
+                                   + (toroidal ? "/toroidal/" : "/bounded/") + suffix.str();
+            if (!suite.wants(name)) {
+                continue;
+            }
+            World world(random_grid(size, density));
+            world.set_engine(engine.second);
+            suite.run(name, size, density, cells, 1, [&] { world.step(toroidal); });
+        }
+    }
+}
+
+/**
+ * Times the Grid operations used around the simulation.
+ */
+static void bench_grid(Suite &suite, int size) {
+    const double cells = static_cast<double>(size) * size;
+    const std::string suffix = std::to_string(size);
+    Grid grid = random_grid(size, 0.3);
+    World world(grid);
+    volatile int sink = 0;
+
+    suite.run("count_neighbours/" + suffix, size, 0.3, cells, 0, [&] {
+        int total = 0;
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++) {
+                total += world.count_neighbours(x, y, true);
+            }
+        }
+        sink = total;
+    });
+    suite.run("get_alive_cells/" + suffix, size, 0.3, cells, 0, [&] { sink = grid.get_alive_cells(); });
+    suite.run("rotate/" + suffix, size, 0.3, cells, 0, [&] { sink = grid.rotate(1).get_width(); });
+    suite.run("crop/" + suffix, size, 0.3, cells / 4, 0, [&] {
+        sink = grid.crop(size / 4, size / 4, size / 4 + size / 2, size / 4 + size / 2).get_width();
+    });
+
+    Grid patch = random_grid(size / 2, 0.3);
+    suite.run("merge/" + suffix, size, 0.3, cells / 4, 0, [&] { grid.merge(patch, size / 4, size / 4); });
+    suite.run("merge_alive_only/" + suffix, size, 0.3, cells / 4, 0, [&] { grid.merge(patch, size / 4, size / 4, true); });
+    (void) sink;
+}
+
+/**
+ * Times saving and loading a grid in each file format, through a file in the working directory.
+ * Each load reads the file written by the save before it.
+ */
+static void bench_zoo(Suite &suite, int size) {
+    const double cells = static_cast<double>(size) * size;
+    const std::string suffix = std::to_string(size);
+    const std::string path = "gol_bench.tmp";
+    const Grid grid = random_grid(size, 0.3);
+    volatile int sink = 0;
+
+    suite.run("zoo/save_ascii/" + suffix, size, 0.3, cells, 0, [&] { Zoo::save_ascii(path, grid); });
+    suite.run("zoo/load_ascii/" + suffix, size, 0.3, cells, 0, [&] { sink = Zoo::load_ascii(path).get_width(); });
+    suite.run("zoo/save_binary/" + suffix, size, 0.3, cells, 0, [&] { Zoo::save_binary(path, grid); });
+    suite.run("zoo/load_binary/" + suffix, size, 0.3, cells, 0, [&] { sink = Zoo::load_binary(path).get_width(); });
+    suite.run("zoo/save_snapshot/" + suffix, size, 0.3, cells, 0, [&] { Zoo::save_snapshot(path, grid); });
+    suite.run("zoo/load_snapshot/" + suffix, size, 0.3, cells, 0, [&] { sink = Zoo::load_binary(path).get_width(); });
+    std::remove(path.c_str());
+    (void) sink;
+}
+
+/**
+ * Writes the results as JSON, one result to a line so they can be read back by read_baseline(path).
+ */
+static void write_json(const std::string &path, const std::vector<Result> &results) {
+    std::ofstream file(path);
+    if (!file) {
+        throw std::runtime_error("File cannot be opened");
+    }
+    file << "{\"suite\": \"gol_bench\", \"results\": [\n";
+    for (std::size_t i = 0; i < results.size(); i++) {
+        const Result &result = results[i];
+        file << "  {\"name\": \"" << result.name << "\", \"size\": " << result.size
+             << ", \"density\": " << std::setprecision(2) << std::fixed << result.density
+             << std::defaultfloat << std::setprecision(6)
+             << ", \"seconds_per_op\": " << result.seconds_per_op
+             << ", \"cells_per_second\": " << result.cells_per_second
+             << ", \"generations_per_second\": " << result.generations_per_second << "}"
+             << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    file << "]}\n";
+}
+
+/**
+ * Reads the cells per second of each benchmark from JSON written by write_json(path, results).
+ */
+static std::map<std::string, double> read_baseline(const std::string &path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("File cannot be opened");
+    }
+    std::map<std::string, double> baseline;
+    std::string line;
+    while (std::getline(file, line)) {
+        const std::string name_key = "\"name\": \"", rate_key = "\"cells_per_second\": ";
+        const std::size_t name = line.find(name_key);
+        const std::size_t rate = line.find(rate_key);
+        if (name == std::string::npos || rate == std::string::npos) {
+            continue;
+        }
+        const std::size_t start = name + name_key.size();
+        baseline[line.substr(start, line.find('"', start) - start)] = std::atof(line.c_str() + rate + rate_key.size());
+    }
+    return baseline;
+}
+
+int main(int argc, char *argv[]) {
+    std::vector<int> sizes;
+    std::string filter, json_path, baseline_path;
+    double min_seconds = 0.25, tolerance = 0.1;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (i + 1 < argc && arg == "--filter") {
+            filter = argv[++i];
+        } else if (i + 1 < argc && arg == "--min-time") {
+            min_seconds = std::atof(argv[++i]);
+        } else if (i + 1 < argc && arg == "--json") {
+            json_path = argv[++i];
+        } else if (i + 1 < argc && arg == "--baseline") {
+            baseline_path = argv[++i];
+        } else if (i + 1 < argc && arg == "--tolerance") {
+            tolerance = std::atof(argv[++i]);
+        } else if (std::atoi(arg.c_str()) > 0) {
+            sizes.push_back(std::atoi(arg.c_str()));
+        } else {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            return 2;
+        }
+    }
+    if (sizes.empty()) {
+        sizes = {256, 1024, 4096};
+    }
+
+    Suite suite(filter, min_seconds);
+    std::cout << std::left << std::setw(44) << "benchmark" << std::right << std::setw(17) << "time"
+              << std::setw(22) << "throughput" << std::endl;
+    for (int size : sizes) {
+        bench_buffer_exchange(suite, size);
+        for (double density : {0.05, 0.3}) {
+            bench_world_step(suite, size, density);
+        }
+        bench_grid(suite, size);
+        bench_zoo(suite, size);
+    }
+
+    try {
+        if (!json_path.empty()) {
+            write_json(json_path, suite.results);
+        }
+
+        // Fail if any benchmark has slowed down beyond the tolerance
+        int regressions = 0;
+        if (!baseline_path.empty()) {
+            const std::map<std::string, double> baseline = read_baseline(baseline_path);
+            for (const Result &result : suite.results) {
+                auto before = baseline.find(result.name);
+                if (before == baseline.end() || before->second <= 0) {
+                    continue;
+                }
+                const double ratio = result.cells_per_second / before->second;
+                if (ratio < 1 - tolerance) {
+                    std::cerr << "Regression: " << result.name << " runs at " << std::fixed << std::setprecision(1)
+                              << ratio * 100 << "% of the baseline" << std::endl;
+                    regressions++;
+                }
+            }
+        }
+        return regressions ? 1 : 0;
+    }
+    catch (const std::exception &ex) {
+        std::cerr << ex.what() << std::endl;
+        return 2;
+    }
+}
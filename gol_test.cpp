@@ -0,0 +1,736 @@
+/**
+ * Regression tests for the Game of Life library.
+ *
+ * Build alongside the library sources, i.e.
+ * g++ -O2 -std=c++11 -pthread gol_test.cpp grid.cpp world.cpp zoo.cpp bitgrid.cpp simd.cpp thread_pool.cpp \
+ *     hashlife.cpp sparse_world.cpp rule.cpp mapped_file.cpp numa.cpp -o gol_test
+ *
+ * Run with no arguments. Each test prints PASS or FAIL, and the exit code is 1 if any failed.
+ *
+ * @author 959133
+ * @date March, 2020
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "grid.h"
+#include "hashlife.h"
+#include "rule.h"
+#include "sparse_world.h"
+#include "thread_pool.h"
+#include "world.h"
+#include "zoo.h"
+
+/**
+ * same_state(a, b)
+ *
+ * Tests whether two grids hold the same cells.
+ */
+static bool same_state(const Grid &a, const Grid &b) {
+    std::ostringstream text_a, text_b;
+    text_a << a;
+    text_b << b;
+    return text_a.str() == text_b.str();
+}
+
+/**
+ * place_block(grid, x, y)
+ *
+ * Places a 2x2 block, a still life under B3/S23, with its top left cell at (x, y).
+ */
+static void place_block(Grid &grid, int x, int y) {
+    for (int dy = 0; dy < 2; dy++) {
+        for (int dx = 0; dx < 2; dx++) {
+            grid.set(x + dx, y + dy, Cell::ALIVE);
+        }
+    }
+}
+
+/**
+ * Stable tiles skipped under one rule must be stepped again once the rule changes.
+ * A block is stable under B3/S23 but dies under B3/S, where nothing survives.
+ */
+static bool test_tile_tracking_rule_change() {
+    Grid grid(100, 100);
+    place_block(grid, 10, 10);
+    World world(grid);
+    world.set_engine(Engine::PACKED);
+    world.set_tile_tracking(true);
+    world.advance(3);
+    world.set_rule(Rule("B3/S"));
+    world.advance(1);
+    return world.get_alive_cells() == 0;
+}
+
+/**
+ * Stable tiles skipped in a bounded world must be stepped again on a torus, where the tiles on opposite
+ * edges become neighbours. Blocks touching the left and right edges are stable apart, but not once joined.
+ */
+static bool test_tile_tracking_topology_change() {
+    Grid grid(200, 100);
+    place_block(grid, 0, 50);
+    place_block(grid, 198, 50);
+    World tracked(grid), reference(grid);
+    tracked.set_engine(Engine::PACKED);
+    tracked.set_tile_tracking(true);
+    tracked.advance(3, false);
+    reference.advance(3, false);
+    tracked.advance(3, true);
+    reference.advance(3, true);
+    return same_state(tracked.get_state(), reference.get_state());
+}
+
+/**
+ * A cycle is only reported once the repeated state is confirmed, and skipping the remaining whole periods
+ * must leave exactly the state reached by running every step. A glider crosses a 32x32 torus in 128 steps.
+ */
+static bool test_cycle_detection_skips_exactly() {
+    Grid grid(32, 32);
+    grid.set(1, 0, Cell::ALIVE);
+    grid.set(2, 1, Cell::ALIVE);
+    grid.set(0, 2, Cell::ALIVE);
+    grid.set(1, 2, Cell::ALIVE);
+    grid.set(2, 2, Cell::ALIVE);
+    for (Engine engine : {Engine::SCALAR, Engine::PACKED, Engine::SIMD}) {
+        World detected(grid), reference(grid);
+        detected.set_engine(engine);
+        detected.set_cycle_detection(200);
+        detected.advance(1000, true);
+        reference.advance(1000, true);
+        if (detected.get_cycle_period() != 128 || detected.get_generation() != 1000
+            || !same_state(detected.get_state(), reference.get_state())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * random_soup(width, height, x0, y0, size, seed)
+ *
+ * Makes a grid that is dead apart from a square of random cells, size wide with its top left at (x0, y0).
+ */
+static Grid random_soup(int width, int height, int x0, int y0, int size, unsigned seed) {
+    std::mt19937 rng(seed);
+    Grid grid(width, height);
+    for (int y = y0; y < y0 + size; y++) {
+        for (int x = x0; x < x0 + size; x++) {
+            grid.set(x, y, (rng() % 2) ? Cell::ALIVE : Cell::DEAD);
+        }
+    }
+    return grid;
+}
+
+/**
+ * HashLife must give the same cells as stepping a World one generation at a time, for jumps that are and are
+ * not powers of two. The soup is far enough from the edges that nothing reaches them in 64 generations.
+ */
+static bool test_hashlife_matches_step() {
+    const Grid grid = random_soup(224, 224, 100, 100, 24, 1);
+    World world(grid);
+    HashLife life(grid);
+    for (int generations : {1, 6, 25, 32}) {
+        world.advance(generations);
+        life.advance(generations);
+        if (!same_state(life.to_grid(0, 0, 224, 224), world.get_state())) {
+            return false;
+        }
+    }
+    return life.get_generation() == 64;
+}
+
+/**
+ * The node cache must stay within the memory limit during long jumps, not just between them,
+ * and collecting part way through a jump must not change the result.
+ */
+static bool test_hashlife_memory_limit() {
+    const std::size_t limit = 2 << 20;
+    const Grid grid = random_soup(96, 96, 0, 0, 96, 2);
+    HashLife limited(grid, limit), unlimited(grid);
+    if (2 * limited.get_memory_usage() > limit) {
+        return false;
+    }
+    limited.advance(4096);
+    unlimited.advance(4096);
+    // The limit is checked before each new result, so it can only be passed by the few nodes made since
+    return limited.get_peak_memory_usage() <= limit + limit / 64
+        && unlimited.get_peak_memory_usage() > 4 * limit
+        && limited.get_alive_cells() == unlimited.get_alive_cells()
+        && same_state(limited.to_grid(-1024, -1024, 2048, 2048), unlimited.to_grid(-1024, -1024, 2048, 2048));
+}
+
+/**
+ * The public neighbour count stays checked, throwing for cells outside the grid rather than reading past it.
+ */
+static bool test_count_neighbours_checked() {
+    Grid grid(4, 4);
+    place_block(grid, 0, 0);
+    World world(grid);
+    if (world.count_neighbours(1, 1, false) != 3 || world.count_neighbours(3, 3, true) != 1) {
+        return false;
+    }
+    for (const std::pair<int, int> &cell : std::vector<std::pair<int, int>>{{2, 7}, {-1, 0}, {4, 0}, {0, -1}}) {
+        try {
+            world.count_neighbours(cell.first, cell.second, false);
+            return false;
+        } catch (const std::out_of_range&) {
+        }
+    }
+    return true;
+}
+
+/**
+ * Only SIMD levels up to the one the CPU supports can be set, and every level that can be set steps alike.
+ */
+static bool test_simd_level_checked() {
+    World reference(random_soup(200, 120, 0, 0, 120, 3));
+    reference.advance(32);
+    const Simd::Level levels[] = {Simd::Level::SCALAR, Simd::Level::SSE2, Simd::Level::AVX2, Simd::Level::AVX512};
+    for (Simd::Level level : levels) {
+        World world(random_soup(200, 120, 0, 0, 120, 3));
+        world.set_engine(Engine::SIMD);
+        try {
+            world.set_simd_level(level);
+        } catch (const std::invalid_argument&) {
+            if (level <= Simd::detect()) {
+                return false;
+            }
+            continue;
+        }
+        if (level > Simd::detect()) {
+            return false;
+        }
+        world.advance(32);
+        if (!same_state(world.get_state(), reference.get_state())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Temporal blocking gives the same cells as single steps whatever size of buffer the strips are stepped in,
+ * including buffers small enough to split the board into many strips.
+ */
+static bool test_temporal_block_bytes() {
+    for (bool toroidal : {false, true}) {
+        World reference(random_soup(300, 200, 0, 0, 200, 5));
+        reference.advance(50, toroidal);
+        for (std::size_t bytes : {std::size_t(2) << 10, std::size_t(4) << 10, std::size_t(256) << 10}) {
+            World world(random_soup(300, 200, 0, 0, 200, 5));
+            world.set_engine(Engine::PACKED);
+            world.set_temporal_blocking(8);
+            world.set_temporal_block_bytes(bytes);
+            world.advance(50, toroidal);
+            if (world.get_temporal_block_bytes() != bytes || !same_state(world.get_state(), reference.get_state())) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Every engine setting that World::advance(steps, toroidal) can use must give the same cells and generation as
+ * the scalar engine taking one step at a time, for bounded and toroidal boards, several rules, widths around
+ * the 64 cells of a packed word, and on one thread or several. The state is read between two advances,
+ * so each setting must also carry on correctly after its state has been brought up to date.
+ */
+static bool test_engine_equivalence() {
+    const std::vector<std::pair<std::string, std::function<void(World&)>>> settings = {
+        {"packed", [](World &world) { world.set_engine(Engine::PACKED); }},
+        {"simd", [](World &world) { world.set_engine(Engine::SIMD); }},
+        {"simd scalar kernel", [](World &world) {
+            world.set_engine(Engine::SIMD);
+            world.set_simd_level(Simd::Level::SCALAR);
+        }},
+        {"tiles", [](World &world) {
+            world.set_engine(Engine::PACKED);
+            world.set_tile_tracking(true);
+        }},
+        {"blocking", [](World &world) {
+            world.set_engine(Engine::PACKED);
+            world.set_temporal_blocking(6);
+            world.set_temporal_block_bytes(1 << 10);
+        }},
+        {"scalar cycles", [](World &world) { world.set_cycle_detection(16); }},
+        {"packed cycles", [](World &world) {
+            world.set_engine(Engine::PACKED);
+            world.set_cycle_detection(16);
+        }},
+    };
+    const std::vector<std::pair<int, int>> sizes = {{1, 1}, {5, 63}, {63, 20}, {64, 64}, {65, 40}, {130, 67}};
+    bool passed = true;
+    for (const std::pair<int, int> &size : sizes) {
+        const Grid soup = random_soup(size.first, size.second, 0, 0, std::min(size.first, size.second), 23);
+        for (const Rule &rule : {Rule(), Rule("B36/S23"), Rule("B2/S")}) {
+            for (bool toroidal : {false, true}) {
+                World reference(soup);
+                reference.set_rule(rule);
+                std::vector<Grid> expected;
+                for (int steps : {60, 90}) {
+                    for (int i = 0; i < steps; i++) {
+                        reference.step(toroidal);
+                    }
+                    expected.push_back(reference.get_state());
+                }
+                for (const auto &setting : settings) {
+                    for (int threads : {1, 3}) {
+                        World world(soup);
+                        world.set_rule(rule);
+                        world.set_threads(threads);
+                        setting.second(world);
+                        world.advance(60, toroidal);
+                        const bool first = same_state(world.get_state(), expected[0]);
+                        world.advance(90, toroidal);
+                        if (!first || !same_state(world.get_state(), expected[1]) || world.get_generation() != 150) {
+                            std::cout << setting.first << " differs on " << size.first << "x" << size.second << " "
+                                      << rule.to_string() << (toroidal ? " toroidal" : "") << " with " << threads
+                                      << " threads" << std::endl;
+                            passed = false;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return passed;
+}
+
+/**
+ * Rules parse from B/S and S/B notation in either case and by name, print back in B/S notation,
+ * and malformed rulestrings or neighbour counts over 8 are rejected.
+ */
+static bool test_rule_parsing() {
+    const std::vector<std::pair<std::string, Rule>> valid = {
+        {"B3/S23", Rule()}, {"b3/s23", Rule()}, {"S23/B3", Rule()}, {"23/3", Rule()}, {"Life", Rule()},
+        {"B36/S23", Rule(0x48, 0x0C)}, {"HIGHLIFE", Rule(0x48, 0x0C)}, {"23/36", Rule(0x48, 0x0C)},
+        {"B2/S", Rule(0x04, 0)}, {"/2", Rule(0x04, 0)}, {"B/S012345678", Rule(0, 0x1FF)},
+    };
+    for (const std::pair<std::string, Rule> &rule : valid) {
+        if (Rule(rule.first) != rule.second || Rule(rule.second.to_string()) != rule.second) {
+            return false;
+        }
+    }
+    if (Rule("b36/s23").to_string() != "B36/S23" || Rule("23/3").to_string() != "B3/S23") {
+        return false;
+    }
+
+    const std::vector<std::string> invalid = {"", "3", "B3", "S23", "B3/S23/", "B9/S23", "B3/S2a", "X3/S23", "B3/B6/S23"};
+    for (const std::string &rulestring : invalid) {
+        try {
+            Rule rule(rulestring);
+            return false;
+        } catch (const std::runtime_error&) {
+        }
+    }
+    try {
+        Rule rule(1u << 9, 0);
+        return false;
+    } catch (const std::runtime_error&) {
+    }
+    return true;
+}
+
+/**
+ * ThreadPool::steal_for(count, grain, body) covers every item exactly once in tasks of at most grain items,
+ * whatever the count and grain, and when one share of the range is far slower than the rest, the other
+ * threads steal from it. The stats count every task and item.
+ */
+static bool test_thread_pool_steal_for() {
+    ThreadPool pool(4);
+    for (const std::pair<int, int> &range : std::vector<std::pair<int, int>>{{0, 5}, {1, 1}, {3, 8}, {1000, 7}, {1001, 0}}) {
+        std::vector<std::atomic<int>> visits(static_cast<std::size_t>(range.first));
+        bool sized = true;
+        pool.steal_for(range.first, range.second, [&](int begin, int end) {
+            if (end - begin > std::max(range.second, 1) || begin >= end) {
+                sized = false;
+            }
+            for (int i = begin; i < end; i++) {
+                visits[static_cast<std::size_t>(i)]++;
+            }
+        });
+        for (const std::atomic<int> &visit : visits) {
+            if (visit != 1) {
+                return false;
+            }
+        }
+        if (!sized) {
+            return false;
+        }
+    }
+
+    // The first quarter of the range is the share of one thread, and each of its tasks sleeps
+    pool.reset_stats();
+    pool.steal_for(4000, 10, [&](int begin, int) {
+        if (begin < 1000) {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    });
+    const ThreadPool::Stats stats = pool.get_stats();
+    long long tasks = 0, items = 0, steals = 0;
+    for (const ThreadPool::ThreadStats &thread : stats.threads) {
+        tasks += thread.tasks;
+        items += thread.items;
+        steals += thread.steals;
+    }
+    return stats.threads.size() == 4 && stats.queued == 400 && tasks == 400 && items == 4000 && steals > 0;
+}
+
+/**
+ * A copied world gets a thread pool of its own, so a world and its copy can be stepped at once from two threads,
+ * and each ends as if stepped alone.
+ */
+static bool test_world_copy_own_pool() {
+    World reference(random_soup(256, 256, 0, 0, 256, 7));
+    reference.advance(64, true);
+
+    World world(random_soup(256, 256, 0, 0, 256, 7));
+    world.set_engine(Engine::PACKED);
+    world.set_threads(4);
+    World copy(world);
+    World assigned;
+    assigned = world;
+    if (copy.get_threads() != 4 || assigned.get_threads() != 4 || copy.get_engine() != Engine::PACKED) {
+        return false;
+    }
+    std::thread other([&copy]() { copy.advance(64, true); });
+    std::thread another([&assigned]() { assigned.advance(64, true); });
+    world.advance(64, true);
+    other.join();
+    another.join();
+    return same_state(world.get_state(), reference.get_state())
+        && same_state(copy.get_state(), reference.get_state())
+        && same_state(assigned.get_state(), reference.get_state());
+}
+
+/**
+ * place_far_cell(life, level, x, y)
+ *
+ * Makes a universe with a root of the given level holding one alive cell at (x, y), which may be far from the origin.
+ */
+static void place_far_cell(HashLife &life, int level, long long x, long long y) {
+    std::function<const HashLife::Node*(int, long long, long long)> make = [&](int at, long long cx, long long cy) {
+        if (at == 0) {
+            return life.leaf(Cell::ALIVE);
+        }
+        const long long half = 1LL << (at - 1);
+        const HashLife::Node *child = make(at - 1, cx % half, cy % half);
+        const HashLife::Node *e = life.empty(at - 1);
+        const bool east = cx >= half, south = cy >= half;
+        return life.join(!east && !south ? child : e, east && !south ? child : e,
+                         !east && south ? child : e, east && south ? child : e);
+    };
+    const long long half = 1LL << (level - 1);
+    life.set_root(make(level, x + half, y + half));
+}
+
+/**
+ * Saving a universe as a macrocell file and loading it back must give the same cells and rule,
+ * both into HashLife and into the sparse world.
+ */
+static bool test_macrocell_round_trip() {
+    const char *path = "gol_test_round_trip.mc";
+    const Grid grid = random_soup(100, 70, 10, 5, 50, 3);
+    Zoo::save_macrocell(path, grid, Rule("B36/S23"));
+    Rule rule;
+    HashLife life = Zoo::load_macrocell(path, rule);
+    bool passed = rule == Rule("B36/S23") && same_state(life.to_grid(0, 0, 100, 70), grid);
+
+    life.advance(100);
+    Zoo::save_macrocell(path, life);
+    HashLife reloaded = Zoo::load_macrocell(path, rule);
+    SparseWorld sparse = Zoo::load_macrocell_sparse(path, rule);
+    long long x0, y0, x1, y1;
+    passed = passed && reloaded.get_alive_cells() == life.get_alive_cells()
+        && sparse.get_alive_cells() == static_cast<long long>(life.get_alive_cells())
+        && sparse.get_bounding_box(x0, y0, x1, y1);
+    if (passed) {
+        // The file holds the cells but not the generation, and the sparse loader keeps the coordinates of HashLife
+        const Grid expected = life.to_grid(x0, y0, static_cast<int>(x1 - x0), static_cast<int>(y1 - y0));
+        passed = same_state(reloaded.to_grid(x0, y0, expected.get_width(), expected.get_height()), expected)
+            && same_state(sparse.to_grid(x0, y0, x1, y1), expected);
+    }
+    std::remove(path);
+    return passed;
+}
+
+/**
+ * Cells far from the origin in a macrocell file must land on their own tiles of the sparse world,
+ * rather than aliasing onto tiles near the origin.
+ */
+static bool test_macrocell_sparse_far_cells() {
+    const char *path = "gol_test_far.mc";
+    const long long far = (1LL << 40) + 1;
+    HashLife life;
+    place_far_cell(life, 62, far, 5);
+    Zoo::save_macrocell(path, life);
+    Rule rule;
+    SparseWorld sparse = Zoo::load_macrocell_sparse(path, rule);
+    HashLife reloaded = Zoo::load_macrocell(path, rule);
+    std::remove(path);
+    return sparse.get_alive_cells() == 1 && sparse.get(far, 5) == Cell::ALIVE && sparse.get(1, 5) == Cell::DEAD
+        && reloaded.get(far, 5) == Cell::ALIVE && reloaded.get_alive_cells() == 1;
+}
+
+/**
+ * load_rle_text(text, rule)
+ *
+ * Writes some RLE text to a file and loads it back with Zoo::load_rle(path, rule).
+ */
+static Grid load_rle_text(const std::string &text, Rule &rule) {
+    const char *path = "gol_test_pattern.rle";
+    {
+        std::ofstream file(path, std::ios_base::binary);
+        file << text;
+    }
+    try {
+        Grid grid = Zoo::load_rle(path, rule);
+        std::remove(path);
+        return grid;
+    } catch (...) {
+        std::remove(path);
+        throw;
+    }
+}
+
+/**
+ * Runs may be split over lines, counts may have several digits, and a count before '$' skips rows.
+ * Comments before the header are skipped.
+ */
+static bool test_rle_runs() {
+    Rule rule;
+    const Grid grid = load_rle_text("#N Runs\n#C A comment, with = signs\nx = 14, y = 5\n"
+                                    "12o\n2o$b2ob\no2$\r\n13bo!", rule);
+    Grid expected(14, 5);
+    for (int x = 0; x < 14; x++) {
+        expected.set(x, 0, Cell::ALIVE);
+    }
+    expected.set(1, 1, Cell::ALIVE);
+    expected.set(2, 1, Cell::ALIVE);
+    expected.set(4, 1, Cell::ALIVE);
+    expected.set(13, 3, Cell::ALIVE);
+    return same_state(grid, expected) && rule == Rule();
+}
+
+/**
+ * The rule of a header runs to the end of the line. Golly's topology suffixes are dropped, the names Life and
+ * HighLife are accepted, and a rule that cannot be parsed falls back to B3/S23 rather than rejecting the file.
+ */
+static bool test_rle_header_rules() {
+    const std::vector<std::pair<std::string, Rule>> cases = {
+        {"x = 3, y = 1, rule = B3/S23:T100,100", Rule("B3/S23")},
+        {"x = 3, y = 1, rule = B36/S23:P10,10", Rule("B36/S23")},
+        {"x = 3, y = 1, rule = Life", Rule("B3/S23")},
+        {"x = 3, y = 1, rule = HighLife", Rule("B36/S23")},
+        {"x = 3, y = 1, rule = 23/36", Rule("B36/S23")},
+        {"x = 3, y = 1, rule = NotARule:T3,1", Rule("B3/S23")},
+    };
+    for (const auto &test : cases) {
+        Rule rule("B2/S");
+        const Grid grid = load_rle_text(test.first + "\n3o!\n", rule);
+        if (!(rule == test.second) || grid.get_alive_cells() != 3) {
+            return false;
+        }
+    }
+
+    // A malformed pattern is still an error
+    try {
+        Rule rule;
+        load_rle_text("x = 2, y = 1\n3o!\n", rule);
+        return false;
+    } catch (const std::runtime_error&) {
+        return true;
+    }
+}
+
+/**
+ * read_bytes(path), write_bytes(path, bytes)
+ *
+ * Reads or writes the whole of a binary file.
+ */
+static std::vector<unsigned char> read_bytes(const std::string &path) {
+    std::ifstream file(path, std::ios_base::binary);
+    return std::vector<unsigned char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+static void write_bytes(const std::string &path, const std::vector<unsigned char> &bytes) {
+    std::ofstream file(path, std::ios_base::binary);
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+}
+
+/**
+ * load_le(bytes, offset, size)
+ *
+ * Reads a little endian integer of size bytes from a file read by read_bytes(path).
+ */
+static unsigned long long load_le(const std::vector<unsigned char> &bytes, std::size_t offset, int size) {
+    unsigned long long value = 0;
+    for (int i = size - 1; i >= 0; i--) {
+        value = (value << 8) | bytes.at(offset + i);
+    }
+    return value;
+}
+
+/**
+ * A v2 snapshot starts with the documented header, and loads back with its cells, rule, and generation,
+ * whichever codec the tiles were written with. Of the six tiles only the four overlapping the soup are written.
+ */
+static bool test_snapshot_header() {
+    const char *path = "gol_test_header.bgol";
+    const Grid grid = random_soup(600, 300, 0, 0, 300, 11);
+    for (Zoo::Codec codec : {Zoo::Codec::NONE, Zoo::Codec::ZERO_RUNS}) {
+        Zoo::save_snapshot(path, grid, Rule("B36/S23"), 12345, codec);
+        const std::vector<unsigned char> bytes = read_bytes(path);
+        Rule rule;
+        long long generation = 0;
+        const Grid loaded = Zoo::load_binary(path, rule, generation);
+        std::remove(path);
+        if (bytes.size() < 56 || std::string(bytes.begin(), bytes.begin() + 4) != "BGOL"
+                || load_le(bytes, 4, 2) != 2 || load_le(bytes, 6, 2) != 0xFEFF
+                || load_le(bytes, 8, 4) != 600 || load_le(bytes, 12, 4) != 300 || load_le(bytes, 16, 4) != 256
+                || bytes[20] != static_cast<unsigned char>(codec)
+                || load_le(bytes, 24, 2) != Rule("B36/S23").get_birth()
+                || load_le(bytes, 26, 2) != Rule("B36/S23").get_survival()
+                || load_le(bytes, 28, 4) != 4 || load_le(bytes, 32, 8) != 12345) {
+            return false;
+        }
+        if (!(rule == Rule("B36/S23")) || generation != 12345 || !same_state(loaded, grid)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * A snapshot with one byte of a tile changed is rejected by the checksum of that tile, both when loading
+ * the whole grid and when loading a region over the tile, while regions over other tiles still load.
+ */
+static bool test_snapshot_tile_crc() {
+    const char *path = "gol_test_corrupt.bgol";
+    const Grid grid = random_soup(600, 520, 0, 0, 520, 13);
+    Zoo::save_snapshot(path, grid, Rule(), 0, Zoo::Codec::NONE);
+    std::vector<unsigned char> bytes = read_bytes(path);
+
+    // Flip a bit in the middle of the first tile of the index, which is stored uncompressed
+    const std::size_t index = static_cast<std::size_t>(load_le(bytes, 40, 8));
+    const unsigned long long number = load_le(bytes, index, 4);
+    const std::size_t offset = static_cast<std::size_t>(load_le(bytes, index + 8, 8));
+    bytes.at(offset + load_le(bytes, index + 4, 4) / 2) ^= 0x10;
+    write_bytes(path, bytes);
+
+    const int tx = static_cast<int>(number % 3) * 256, ty = static_cast<int>(number / 3) * 256;
+    const int ox = tx == 0 ? 256 : 0;
+    bool passed = same_state(Zoo::load_region(path, ox + 10, ty + 10, ox + 50, ty + 50),
+                             grid.crop(ox + 10, ty + 10, ox + 50, ty + 50));
+    const std::vector<std::function<void()>> loads = {
+        [&]() { Zoo::load_binary(path); },
+        [&]() { Zoo::load_binary_packed(path); },
+        [&]() { Zoo::load_region(path, tx + 10, ty + 10, tx + 20, ty + 20); },
+    };
+    for (const std::function<void()> &load : loads) {
+        try {
+            load();
+            passed = false;
+        } catch (const std::runtime_error&) {
+        }
+    }
+    std::remove(path);
+    return passed;
+}
+
+/**
+ * A v1 binary file, with no magic bytes, still loads in full and by region, with the default rule and generation 0.
+ */
+static bool test_binary_v1_compat() {
+    const char *path = "gol_test_v1.bgol";
+    const Grid grid = random_soup(203, 97, 0, 0, 97, 17);
+    Zoo::save_binary(path, grid);
+    const std::vector<unsigned char> bytes = read_bytes(path);
+    Rule rule("B36/S23");
+    long long generation = 99;
+    const Grid loaded = Zoo::load_binary(path, rule, generation);
+    bool passed = std::string(bytes.begin(), bytes.begin() + 4) != "BGOL"
+        && rule == Rule() && generation == 0 && same_state(loaded, grid)
+        && same_state(Zoo::load_binary_packed(path).to_grid(), grid)
+        && same_state(Zoo::load_region(path, 61, 7, 130, 90), grid.crop(61, 7, 130, 90))
+        && same_state(Zoo::load_region(path, 0, 0, 203, 97), grid);
+    std::remove(path);
+    return passed;
+}
+
+/**
+ * Regions of a snapshot are clipped exactly at the edges of the 256x256 tiles they overlap, including regions
+ * ending on a tile edge, crossing a corner of four tiles, one cell wide, empty, and over tiles left out as dead.
+ */
+static bool test_load_region_tile_boundaries() {
+    const char *path = "gol_test_region.bgol";
+    const Grid grid = random_soup(600, 520, 0, 0, 520, 19);
+    Zoo::save_snapshot(path, grid);
+    const std::vector<std::vector<int>> regions = {
+        {0, 0, 256, 256}, {250, 250, 262, 262}, {255, 0, 257, 520}, {0, 255, 600, 257},
+        {256, 256, 256, 300}, {511, 511, 513, 513}, {520, 0, 600, 520}, {512, 256, 600, 520}, {0, 0, 600, 520},
+    };
+    bool passed = true;
+    for (const std::vector<int> &r : regions) {
+        passed = passed && same_state(Zoo::load_region(path, r[0], r[1], r[2], r[3]), grid.crop(r[0], r[1], r[2], r[3]));
+    }
+    try {
+        Zoo::load_region(path, 500, 500, 601, 520);
+        passed = false;
+    } catch (const std::runtime_error&) {
+    }
+    std::remove(path);
+    return passed;
+}
+
+int main() {
+    const std::vector<std::pair<std::string, std::function<bool()>>> tests = {
+        {"tile_tracking_rule_change", test_tile_tracking_rule_change},
+        {"tile_tracking_topology_change", test_tile_tracking_topology_change},
+        {"cycle_detection_skips_exactly", test_cycle_detection_skips_exactly},
+        {"count_neighbours_checked", test_count_neighbours_checked},
+        {"world_copy_own_pool", test_world_copy_own_pool},
+        {"simd_level_checked", test_simd_level_checked},
+        {"temporal_block_bytes", test_temporal_block_bytes},
+        {"engine_equivalence", test_engine_equivalence},
+        {"rule_parsing", test_rule_parsing},
+        {"thread_pool_steal_for", test_thread_pool_steal_for},
+        {"hashlife_matches_step", test_hashlife_matches_step},
+        {"hashlife_memory_limit", test_hashlife_memory_limit},
+        {"macrocell_round_trip", test_macrocell_round_trip},
+        {"macrocell_sparse_far_cells", test_macrocell_sparse_far_cells},
+        {"rle_runs", test_rle_runs},
+        {"rle_header_rules", test_rle_header_rules},
+        {"snapshot_header", test_snapshot_header},
+        {"snapshot_tile_crc", test_snapshot_tile_crc},
+        {"binary_v1_compat", test_binary_v1_compat},
+        {"load_region_tile_boundaries", test_load_region_tile_boundaries},
+    };
+
+    int failures = 0;
+    for (const auto &test : tests) {
+        bool passed = false;
+        try {
+            passed = test.second();
+        } catch (const std::exception &ex) {
+            std::cout << test.first << ": " << ex.what() << std::endl;
+        }
+        std::cout << (passed ? "PASS " : "FAIL ") << test.first << std::endl;
+        failures += passed ? 0 : 1;
+    }
+    return failures ? 1 : 0;
+}
@@ -17,6 +17,8 @@
 // #include ...
 
 #include <algorithm>
+#include <cstring>
+#include <string>
 
 /**
  * Grid::Grid()
@@ -65,7 +67,7 @@ Grid::Grid(int square_size){
     this->width = square_size;
     this->height = square_size;
 
-    grid.resize(square_size*square_size, Cell::DEAD);
+    grid.resize(static_cast<std::size_t>(square_size) * square_size, Cell::DEAD);
     
 }
 
@@ -89,7 +91,7 @@ Grid::Grid(int width, int height){
     this->width = width;
     this->height = height;
 
-    grid.resize(width*height, Cell::DEAD);
+    grid.resize(static_cast<std::size_t>(width) * height, Cell::DEAD);
 }
 
 /**
@@ -169,9 +171,9 @@ int Grid::get_height() const{
  * @return
  *      The number of total cells.
  */
-int Grid::get_total_cells() const{
+long long Grid::get_total_cells() const{
 
-    return this->width*this->height;
+    return static_cast<long long>(this->width) * this->height;
 };
 
 /**
@@ -197,8 +199,8 @@ int Grid::get_total_cells() const{
  * @return
  *      The number of alive cells.
  */
-int Grid::get_alive_cells() const{
-    int alive = 0;
+long long Grid::get_alive_cells() const{
+    long long alive = 0;
     for (auto it = std::begin(grid); it != std::end(grid); it++) {
         if (*it == Cell::ALIVE) {
             alive++;
@@ -231,8 +233,8 @@ int Grid::get_alive_cells() const{
  * @return
  *      The number of dead cells.
  */
-int Grid::get_dead_cells() const{
-    int dead = get_total_cells() - get_alive_cells();
+long long Grid::get_dead_cells() const{
+    long long dead = get_total_cells() - get_alive_cells();
     return dead;
 };
 
@@ -254,48 +256,7 @@ int Grid::get_dead_cells() const{
  *      The new edge size for both the width and height of the grid.
  */
 void Grid::resize(int square_size){
-   
-    std::vector<Cell> temp(get_total_cells());
-
-    temp = this->grid;
-
-    this->grid.clear();
-    this->grid.resize(square_size*square_size, Cell::DEAD);
-
-    int oldWidth = get_width();
-    if (get_total_cells() > square_size*square_size){ 
-        //Get smaller
-        for (int y = 0; y < get_height(); y++) {
-            for (int x = 0; x < get_width(); x++) {
-                try {
-                    if (temp[get_index(x,y)] == Cell::ALIVE) {
-                        this->width = square_size;
-                        set(x,y, Cell::ALIVE);
-                        this->width = oldWidth;
-                    }
-                } catch (const std::exception &) {
-
-                }
-                
-            }
-        }
-    } else {
-        //Get larger
-        for (int y = 0; y < get_height(); y++) {
-            for (int x = 0; x < get_width(); x++) {
-                if (temp[get_index(x,y)] == Cell::ALIVE) {
-                    this->width = square_size;
-                    set(x,y, Cell::ALIVE);
-                    this->width = oldWidth;
-                } else {
-                    this->width = square_size;
-                    set(x,y, Cell::DEAD);
-                    this->width = oldWidth;
-                }
-            }
-        }
-    }
-    this->width = square_size;
+    resize(square_size, square_size);
 };
 
 /**
@@ -319,48 +280,16 @@ void Grid::resize(int square_size){
  *      The new height for the grid.
  */
 void Grid::resize(int new_width, int new_height){   
+    std::vector<Cell> temp(static_cast<std::size_t>(new_width) * new_height, Cell::DEAD);
 
-    std::vector<Cell> temp(get_total_cells());
-
-    temp = this->grid;
-
-    this->grid.clear();
-    this->grid.resize(new_width*new_height, Cell::DEAD);
-
-    int oldWidth = get_width();
-    if (get_total_cells() > new_width*new_height){ 
-
-        //Get smaller
-        for (int y = 0; y < new_height; y++) {
-            for (int x = 0; x < new_width; x++) {
-                try {
-                    if (temp[get_index(x,y)] == Cell::ALIVE) {
-                        this->width = new_width;
-                        set(x,y, Cell::ALIVE);
-                        this->width = oldWidth;
-                    }
-                } catch (const std::exception &) {
-
-                }
-                
-            }
-        }
-    } else {
-        //Get larger
-        for (int y = 0; y < get_height(); y++) {
-            for (int x = 0; x < get_width(); x++) {
-                if (temp[get_index(x,y)] == Cell::ALIVE) {
-                    this->width = new_width;
-                    set(x,y, Cell::ALIVE);
-                    this->width = oldWidth;
-                } else {
-                    this->width = new_width;
-                    set(x,y, Cell::DEAD);
-                    this->width = oldWidth;
-                }
-            }
-        }
+    // Copy the kept region a row at a time
+    const int kept_width = std::min(get_width(), new_width);
+    const int kept_height = std::min(get_height(), new_height);
+    for (int y = 0; y < kept_height; y++) {
+        std::copy(row(y), row(y) + kept_width, temp.begin() + static_cast<std::size_t>(y) * new_width);
     }
+
+    this->grid.swap(temp);
     this->width = new_width;
     this->height = new_height;
 };
@@ -381,8 +310,8 @@ void Grid::resize(int new_width, int new_height){
  * @return
  *      The 1d offset from the start of the data array where the desired cell is located.
  */
-int Grid::get_index(int x, int y) const{
-    return y * get_width() + x;
+std::size_t Grid::get_index(int x, int y) const{
+    return static_cast<std::size_t>(y) * get_width() + x;
 };
 
 /**
@@ -414,11 +343,11 @@ int Grid::get_index(int x, int y) const{
  *      std::exception or sub-class if x,y is not a valid coordinate within the grid.
  */
 Cell Grid::get(int x, int y) const{
-    if (x > get_width() || x < 0 || y > get_height() || y < 0) {
+    if (x >= get_width() || x < 0 || y >= get_height() || y < 0) {
         throw std::exception();
     }
     
-    return operator()(x,y);
+    return grid[get_index(x,y)];
 
 };
 
@@ -449,13 +378,11 @@ Cell Grid::get(int x, int y) const{
  *      std::exception or sub-class if x,y is not a valid coordinate within the grid.
  */
 void Grid::set(int x, int y, Cell value){
-    if (x > get_width() || x < 0 || y > get_height() || y < 0) {
+    if (x >= get_width() || x < 0 || y >= get_height() || y < 0) {
         throw std::exception();
     }
    
-    Cell& reference = operator()(x,y);
-    reference = value;
-    grid[get_index(x,y)] = reference;
+    grid[get_index(x,y)] = value;
 };
 
 /**
@@ -494,7 +421,7 @@ void Grid::set(int x, int y, Cell value){
  *      std::runtime_error or sub-class if x,y is not a valid coordinate within the grid.
  */
 Cell& Grid::operator()(int x, int y) {
-    if (x > get_width() || x < 0 || y > get_height() || y < 0) {
+    if (x >= get_width() || x < 0 || y >= get_height() || y < 0) {
         throw std::runtime_error("Coordinates out of scope");
     }
     
@@ -532,7 +459,7 @@ Cell& Grid::operator()(int x, int y) {
  *      std::exception or sub-class if x,y is not a valid coordinate within the grid.
  */
 const Cell& Grid::operator()(int x, int y) const {
-    if (x > get_width() || x < 0 || y > get_height() || y < 0) {
+    if (x >= get_width() || x < 0 || y >= get_height() || y < 0) {
         throw std::runtime_error("Coordinates out of scope");
     }
     
@@ -575,24 +502,13 @@ const Cell& Grid::operator()(int x, int y) const {
  *      or if the crop window has a negative size.
  */
 Grid Grid::crop(int x0,int y0,int x1,int y1) const{
- 
-    int gridWidth = x1 - x0;
-    int gridHeight = y1 - y0;
-
-    if (gridWidth*gridHeight > get_total_cells() || gridWidth*gridHeight < 0) {
+    if (x0 < 0 || y0 < 0 || x1 < x0 || y1 < y0 || x1 > get_width() || y1 > get_height()) {
         throw std::exception();
     }
-    Grid temp;
-
-    temp.width = gridWidth;
-    temp.height = gridHeight;
-
+    Grid temp(x1 - x0, y1 - y0);
     for (int y = y0; y < y1; y++) {
-        for (int x = x0; x < x1; x++ ) {
-            temp.grid.push_back(grid[get_index(x,y)]);
-        }
+        std::copy(row(y) + x0, row(y) + x1, temp.row(y - y0));
     }
-
     return temp;
 }
 
@@ -637,24 +553,24 @@ void Grid::merge(Grid other, int x0, int y0, bool alive_only) {
     if (x0 < 0 || y0 < 0){
         throw std::exception();
     }
-    
-    for (int y = y0; y < other.height+y0; y++) {
-        for (int x = x0; x < other.width+x0; x++) {
-            if (other.height+y0 > get_height() || other.width+x0 > get_width()) {
-                throw std::exception();
-            } else {
-                if (alive_only == true) {
-                    if (other.get(x-x0,y-y0) == Cell::ALIVE) {
-                        set(x,y, Cell::ALIVE);
-                    } else if (get(x,y) == Cell::ALIVE){
-                        set(x,y, Cell::ALIVE);
-                    } else {    
-                        set(x,y, other.get(x-x0,y-y0));
-                    }
-                } else {
-                    set(x,y, other.get(x-x0,y-y0));
+    if (other.width == 0 || other.height == 0) {
+        return;
+    }
+    if (other.height+y0 > get_height() || other.width+x0 > get_width()) {
+        throw std::exception();
+    }
+
+    for (int y = 0; y < other.height; y++) {
+        const Cell *from = other.row(y);
+        Cell *to = row(y + y0) + x0;
+        if (alive_only == true) {
+            for (int x = 0; x < other.width; x++) {
+                if (from[x] == Cell::ALIVE) {
+                    to[x] = Cell::ALIVE;
                 }
             }
+        } else {
+            std::copy(from, from + other.width, to);
         }
     }
 }
@@ -682,37 +598,34 @@ void Grid::merge(Grid other, int x0, int y0, bool alive_only) {
  *      Returns a copy of the grid that has been rotated.
  */
 Grid Grid::rotate(int rotation) const{
-    Grid temp(get_total_cells());
-    temp.grid.erase(temp.grid.begin(), temp.grid.end());
-    temp.grid = this->grid;
-    
-    temp.height = get_width();
-    temp.width = get_height();
-
     rotation = rotation%4;
+    if (rotation == 0) {
+        return *this;
+    }
 
+    Grid temp(get_height(), get_width());
+    const int width = get_width();
+    const int height = get_height();
     if (rotation == 1 || rotation == -3) {
-        for (int y = 0; y < get_height(); y++) {
-            for (int x = 0; x < get_width(); x++) {
-                temp.set(y,x, get(x,get_height()-1-y));
+        // Row x of the result is column x read from the bottom up
+        for (int y = 0; y < height; y++) {
+            const Cell *from = row(height - 1 - y);
+            for (int x = 0; x < width; x++) {
+                temp.row(x)[y] = from[x];
             }
         }
-
     } else if (rotation == -1 || rotation ==3 ) {
-        for (int y = 0; y < get_height(); y++) {
-            for (int x = 0; x < get_width(); x++) {
-                temp.set(y,x, get(get_width()-1-x, y));
+        // Row x of the result is column (width - 1 - x) read from the top down
+        for (int y = 0; y < height; y++) {
+            const Cell *from = row(y);
+            for (int x = 0; x < width; x++) {
+                temp.row(x)[y] = from[width - 1 - x];
             }
         }
-    } else if (rotation == 2 || rotation == -2)  {
-        
-        temp.width = get_width();
-        temp.height = get_height();
-    
-        std::reverse(temp.grid.begin(), temp.grid.end());
-
-    } else if (rotation == 0){
-        return *this;
+    } else {
+        temp.width = width;
+        temp.height = height;
+        temp.grid.assign(grid.rbegin(), grid.rend());
     }
     return temp;
 }
@@ -726,6 +639,9 @@ Grid Grid::rotate(int rotation) const{
  *
  * The function should be callable on a constant Grid.
  *
+ * The frame is written a line at a time from a buffer of one line. As a Cell is stored as the character
+ * it is printed with, each row is copied into the buffer whole, so printing a grid needs only one line of memory.
+ *
  * @example
  *
  *      // Make a 3x3 grid with a single alive cell
@@ -752,29 +668,32 @@ Grid Grid::rotate(int rotation) const{
  * @return
  *      Returns a reference to the output stream to enable operator chaining.
  */
-std::ostream & operator<<(std::ostream & output_stream, const Grid grid) { 
-    
-    output_stream << "+";
-    for (int i = 0; i < grid.get_width(); i++) {
-        output_stream << "-";
-    }
-    output_stream << "+\n";
-    for (int y = 0; y < grid.get_height(); y++) {
-        output_stream << "|";
-        for (int x = 0; x < grid.get_width(); x++) {
-            Cell v = grid.get(x,y);
-            if (v == 32) {
-                output_stream << " ";
-            } else if (v == 35) {
-                output_stream << "#";
-            }
-        }
-        output_stream << "|\n";
-    }
-    output_stream << "+";
-    for (int i = 0; i < grid.get_width(); i++) {
-        output_stream << "-";
+std::ostream & operator<<(std::ostream & output_stream, const Grid &grid) {
+    static_assert(sizeof(Cell) == sizeof(char), "Cells must be stored as their characters");
+
+    const std::size_t width = static_cast<std::size_t>(grid.get_width());
+    const std::size_t height = static_cast<std::size_t>(grid.get_height());
+    const std::streamsize length = static_cast<std::streamsize>(width + 3);
+
+    // Top border
+    std::string line(width + 3, '-');
+    line[0] = '+';
+    line[width + 1] = '+';
+    line[width + 2] = '\n';
+    output_stream.write(line.data(), length);
+
+    // Each row of cells between a pair of pipes
+    line[0] = '|';
+    line[width + 1] = '|';
+    for (std::size_t y = 0; y < height; y++) {
+        std::memcpy(&line[1], grid.grid.data() + y * width, width);
+        output_stream.write(line.data(), length);
     }
-    output_stream << "+\n";
+
+    // Bottom border
+    line[0] = '+';
+    std::memset(&line[1], '-', width);
+    line[width + 1] = '+';
+    output_stream.write(line.data(), length);
     return output_stream;
 }
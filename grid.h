@@ -44,12 +44,12 @@ public:
 
     int get_width() const;
     int get_height() const;
-    int get_total_cells() const;
-    int get_alive_cells() const;
-    int get_dead_cells() const;
+    long long get_total_cells() const;
+    long long get_alive_cells() const;
+    long long get_dead_cells() const;
     void resize(int square_size);
     void resize(int new_width, int new_height);
-    int get_index(int x, int y) const;
+    std::size_t get_index(int x, int y) const;
     Cell get(int x, int y) const;
     void set(int x, int y, Cell value);
     Grid crop(int x0, int y0, int x1, int y1) const;
@@ -58,6 +58,87 @@ public:
 
     Cell& operator()(int x, int y);
     const Cell& operator()(int x, int y) const; 
+
+    Cell* row(int y);
+    const Cell* row(int y) const;
+    Cell get_unchecked(int x, int y) const;
+    void set_unchecked(int x, int y, Cell value);
 };
 
-std::ostream & operator<<(std::ostream & output_stream, const Grid grid);
\ No newline at end of file
+/**
+ * Grid::row(y)
+ *
+ * Gets the cells of row y, without checking y is within the grid.
+ * The row is Grid::get_width() cells long, and is followed directly by row y + 1.
+ * Defined in the header, as are the other unchecked accessors, so that hot loops inline them.
+ *
+ * @example
+ *
+ *      // Count the alive cells of a row
+ *      const Cell *cells = grid.row(y);
+ *      int alive = std::count(cells, cells + grid.get_width(), Cell::ALIVE);
+ *
+ * @param y
+ *      The y coordinate of the row.
+ *
+ * @return
+ *      A pointer to the first cell of the row.
+ */
+inline Cell* Grid::row(int y) {
+    return grid.data() + static_cast<std::size_t>(y) * width;
+}
+
+/**
+ * Grid::row(y)
+ *
+ * Gets the cells of row y, without checking y is within the grid.
+ * The function should be callable from a constant context.
+ *
+ * @param y
+ *      The y coordinate of the row.
+ *
+ * @return
+ *      A read-only pointer to the first cell of the row.
+ */
+inline const Cell* Grid::row(int y) const {
+    return grid.data() + static_cast<std::size_t>(y) * width;
+}
+
+/**
+ * Grid::get_unchecked(x, y)
+ *
+ * Gets the value of a cell, without checking x,y is within the grid. See Grid::get(x, y) for the checked version.
+ *
+ * @param x
+ *      The x coordinate of the cell, from 0 to Grid::get_width() - 1.
+ *
+ * @param y
+ *      The y coordinate of the cell, from 0 to Grid::get_height() - 1.
+ *
+ * @return
+ *      The value of the cell.
+ */
+inline Cell Grid::get_unchecked(int x, int y) const {
+    return row(y)[x];
+}
+
+/**
+ * Grid::set_unchecked(x, y, value)
+ *
+ * Overwrites the value of a cell, without checking x,y is within the grid. See Grid::set(x, y, value)
+ * for the checked version.
+ *
+ * @param x
+ *      The x coordinate of the cell, from 0 to Grid::get_width() - 1.
+ *
+ * @param y
+ *      The y coordinate of the cell, from 0 to Grid::get_height() - 1.
+ *
+ * @param value
+ *      The value to be written to the cell.
+ */
+inline void Grid::set_unchecked(int x, int y, Cell value) {
+    row(y)[x] = value;
+}
+
+std::ostream & operator<<(std::ostream & output_stream, const Grid &grid);
\ No newline at end of file
@@ -0,0 +1,831 @@
+/**
+ * Implements a class representing an unbounded Game of Life universe simulated with the HashLife algorithm.
+ * https://en.wikipedia.org/wiki/Hashlife
+ *
+ *      - The universe is a quadtree of canonical nodes. Each distinct square of cells is stored only once,
+ *        looked up in a hash set by the addresses of its four children.
+ *
+ *      - The result of advancing a node is memoised on the node, so repeated structure in space and time
+ *        is only ever computed once.
+ *          - Advancing a node of size 2^k by 2^(k-2) generations gives its centre square of size 2^(k-1).
+ *          - Smaller jumps of 2^j generations are memoised separately by (node, j).
+ *
+ *      - HashLife::advance(generations) jumps by the powers of two making up the number of generations,
+ *        so advancing 10^9 generations takes about 30 jumps.
+ *
+ *      - The universe is centred on the origin and grows as needed. Grids are imported with their top left
+ *        cell at (0, 0), and any window of the plane can be exported back into a Grid.
+ *
+ *      - The node cache is bounded. Once its estimated size passes the memory limit, the nodes no longer
+ *        reachable from the current universe, or from the jump in progress, and their memoised results
+ *        are garbage collected, between jumps and during them.
+ *
+ * @author 959133
+ * @date March, 2020
+ */
+#include "hashlife.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+/**
+ * HashLife::NodeHash::operator()(node)
+ *
+ * Hashes a node by the addresses of its children, which are themselves canonical.
+ */
+std::size_t HashLife::NodeHash::operator()(const Node *node) const {
+    std::size_t hash = reinterpret_cast<std::uintptr_t>(node->nw);
+    hash = hash * 1000003u ^ reinterpret_cast<std::uintptr_t>(node->ne);
+    hash = hash * 1000003u ^ reinterpret_cast<std::uintptr_t>(node->sw);
+    hash = hash * 1000003u ^ reinterpret_cast<std::uintptr_t>(node->se);
+    return hash ^ (hash >> 17);
+}
+
+/**
+ * HashLife::NodeEqual::operator()(a, b)
+ *
+ * Compares two nodes by the addresses of their children.
+ */
+bool HashLife::NodeEqual::operator()(const Node *a, const Node *b) const {
+    return a->nw == b->nw && a->ne == b->ne && a->sw == b->sw && a->se == b->se;
+}
+
+/**
+ * HashLife::StepKey::operator==(other)
+ *
+ * Compares two memoised step keys.
+ */
+bool HashLife::StepKey::operator==(const StepKey &other) const {
+    return node == other.node && step == other.step;
+}
+
+/**
+ * HashLife::StepKeyHash::operator()(key)
+ *
+ * Hashes a memoised step key.
+ */
+std::size_t HashLife::StepKeyHash::operator()(const StepKey &key) const {
+    std::size_t hash = reinterpret_cast<std::uintptr_t>(key.node) * 1000003u ^ static_cast<std::size_t>(key.step);
+    return hash ^ (hash >> 17);
+}
+
+/**
+ * HashLife::HashLife(memory_limit)
+ *
+ * Construct an empty universe.
+ *
+ * @example
+ *
+ *      // Make an empty universe with a 256 MiB node cache
+ *      HashLife life(256 << 20);
+ *
+ * @param memory_limit
+ *      Optional parameter. The size in bytes the node cache may reach before it is garbage collected.
+ *      Defaults to 1 GiB.
+ */
+HashLife::HashLife(std::size_t memory_limit)
+        : generation(0), memory_limit(memory_limit), collect_at(memory_limit), peak_usage(0) {
+    dead_leaf = new Node{nullptr, nullptr, nullptr, nullptr, nullptr, 0, 0, false};
+    alive_leaf = new Node{nullptr, nullptr, nullptr, nullptr, nullptr, 1, 0, false};
+    root = empty(3);
+}
+
+/**
+ * HashLife::HashLife(grid, memory_limit)
+ *
+ * Construct a universe holding the contents of a grid, with the top left of the grid at (0, 0).
+ *
+ * @example
+ *
+ *      // Make a universe containing an r-pentomino
+ *      HashLife life(Zoo::r_pentomino());
+ *
+ * @param grid
+ *      The initial contents of the universe. Everything outside the grid is dead.
+ *
+ * @param memory_limit
+ *      Optional parameter. The size in bytes the node cache may reach before it is garbage collected.
+ *      Defaults to 1 GiB.
+ */
+HashLife::HashLife(const Grid &grid, std::size_t memory_limit) : HashLife(memory_limit) {
+    set_grid(grid);
+}
+
+/**
+ * HashLife::HashLife(other)
+ *
+ * Construct a copy of another universe. Only the nodes reachable from the other universe are copied,
+ * its memoised results are not.
+ *
+ * @param other
+ *      The universe to copy.
+ */
+HashLife::HashLife(const HashLife &other) : HashLife(other.memory_limit) {
+    std::unordered_map<const Node*, const Node*> copies;
+    root = copy(other.root, copies);
+    generation = other.generation;
+    rule = other.rule;
+}
+
+/**
+ * HashLife::HashLife(other)
+ *
+ * Construct a universe by taking the nodes of another. The other universe may only be destroyed
+ * or assigned to afterwards.
+ *
+ * @param other
+ *      The universe to move from.
+ */
+HashLife::HashLife(HashLife &&other)
+        : dead_leaf(nullptr), alive_leaf(nullptr), root(nullptr), generation(0), memory_limit(0),
+          collect_at(0), peak_usage(0) {
+    swap(other);
+}
+
+/**
+ * HashLife::operator=(other)
+ *
+ * Replaces this universe with a copy of (or the moved contents of) another.
+ *
+ * @param other
+ *      The universe to assign from.
+ *
+ * @return
+ *      A reference to this universe.
+ */
+HashLife& HashLife::operator=(HashLife other) {
+    swap(other);
+    return *this;
+}
+
+/**
+ * HashLife::~HashLife()
+ *
+ * Frees every node.
+ */
+HashLife::~HashLife() {
+    release();
+}
+
+/**
+ * HashLife::swap(other)
+ *
+ * Exchanges the contents of two universes in constant time.
+ *
+ * @param other
+ *      The universe to swap with.
+ */
+void HashLife::swap(HashLife &other) {
+    std::swap(nodes, other.nodes);
+    std::swap(steps, other.steps);
+    std::swap(empties, other.empties);
+    std::swap(dead_leaf, other.dead_leaf);
+    std::swap(alive_leaf, other.alive_leaf);
+    std::swap(root, other.root);
+    std::swap(generation, other.generation);
+    std::swap(memory_limit, other.memory_limit);
+    std::swap(in_flight, other.in_flight);
+    std::swap(collect_at, other.collect_at);
+    std::swap(peak_usage, other.peak_usage);
+    std::swap(rule, other.rule);
+}
+
+/**
+ * HashLife::release()
+ *
+ * Private helper function to free every node.
+ */
+void HashLife::release() {
+    for (Node *node : nodes) {
+        delete node;
+    }
+    nodes.clear();
+    steps.clear();
+    empties.clear();
+    delete dead_leaf;
+    delete alive_leaf;
+    dead_leaf = nullptr;
+    alive_leaf = nullptr;
+    root = nullptr;
+}
+
+/**
+ * HashLife::leaf(value)
+ *
+ * Gets the canonical node for a single cell.
+ *
+ * @param value
+ *      The value of the cell.
+ *
+ * @return
+ *      The level 0 node for the cell.
+ */
+const HashLife::Node* HashLife::leaf(Cell value) const {
+    return (value == Cell::ALIVE) ? alive_leaf : dead_leaf;
+}
+
+/**
+ * HashLife::empty(level)
+ *
+ * Gets the canonical node for a square of 2^level by 2^level dead cells.
+ *
+ * @param level
+ *      The level of the node.
+ *
+ * @return
+ *      The empty node.
+ */
+const HashLife::Node* HashLife::empty(int level) {
+    if (empties.empty()) {
+        empties.push_back(dead_leaf);
+    }
+    while (static_cast<int>(empties.size()) <= level) {
+        const Node *e = empties.back();
+        empties.push_back(join(e, e, e, e));
+    }
+    return empties[level];
+}
+
+/**
+ * HashLife::join(nw, ne, sw, se)
+ *
+ * Gets the canonical node made of four children, creating it if it does not already exist.
+ *
+ * @example
+ *
+ *      // Make a 2x2 block of alive cells
+ *      const HashLife::Node *on = life.leaf(Cell::ALIVE);
+ *      const HashLife::Node *block = life.join(on, on, on, on);
+ *
+ * @param nw, ne, sw, se
+ *      The four quadrants of the node. All must be canonical nodes of this universe with the same level.
+ *
+ * @return
+ *      The canonical node.
+ *
+ * @throws
+ *      std::runtime_error or sub-class if the children are not all the same level.
+ */
+const HashLife::Node* HashLife::join(const Node *nw, const Node *ne, const Node *sw, const Node *se) {
+    if (nw->level != ne->level || nw->level != sw->level || nw->level != se->level) {
+        throw std::runtime_error("Quadrants must be the same size");
+    }
+
+    Node probe{nw, ne, sw, se, nullptr, 0, 0, false};
+    auto found = nodes.find(&probe);
+    if (found != nodes.end()) {
+        return *found;
+    }
+
+    Node *node = new Node{nw, ne, sw, se, nullptr,
+                          nw->population + ne->population + sw->population + se->population,
+                          nw->level + 1, false};
+    nodes.insert(node);
+    return node;
+}
+
+/**
+ * HashLife::get_root()
+ *
+ * Gets the node holding the whole universe, centred on the origin.
+ *
+ * @return
+ *      The root node.
+ */
+const HashLife::Node* HashLife::get_root() const {
+    return root;
+}
+
+/**
+ * HashLife::set_root(node)
+ *
+ * Replaces the whole universe with a node, centred on the origin.
+ *
+ * @param node
+ *      A canonical node of this universe.
+ */
+void HashLife::set_root(const Node *node) {
+    root = node;
+    while (root->level < 3) {
+        root = expand(root);
+    }
+}
+
+/**
+ * HashLife::set_grid(grid)
+ *
+ * Replaces the universe with the contents of a grid, with the top left of the grid at (0, 0),
+ * and resets the generation counter.
+ *
+ * @param grid
+ *      The new contents of the universe. Everything outside the grid is dead.
+ */
+void HashLife::set_grid(const Grid &grid) {
+    int level = 3;
+    while ((1LL << (level - 1)) < std::max(grid.get_width(), grid.get_height())) {
+        level++;
+    }
+    long long half = 1LL << (level - 1);
+    root = build(grid, -half, -half, level);
+    generation = 0;
+    peak_usage = get_memory_usage();
+}
+
+/**
+ * HashLife::build(grid, x0, y0, level)
+ *
+ * Private helper function to build the node covering the square of 2^level cells with its top left at (x0, y0).
+ */
+const HashLife::Node* HashLife::build(const Grid &grid, long long x0, long long y0, int level) {
+    long long size = 1LL << level;
+    if (x0 >= grid.get_width() || y0 >= grid.get_height() || x0 + size <= 0 || y0 + size <= 0) {
+        return empty(level);
+    }
+    if (level == 0) {
+        return leaf(grid.grid[y0 * grid.get_width() + x0]);
+    }
+    long long half = size / 2;
+    return join(build(grid, x0, y0, level - 1), build(grid, x0 + half, y0, level - 1),
+                build(grid, x0, y0 + half, level - 1), build(grid, x0 + half, y0 + half, level - 1));
+}
+
+/**
+ * HashLife::to_grid(x0, y0, width, height)
+ *
+ * Exports a window of the universe to a grid. Only the parts of the tree with alive cells inside
+ * the window are visited.
+ *
+ * @example
+ *
+ *      // Look at the 64x64 square of the universe around the origin
+ *      Grid window = life.to_grid(-32, -32, 64, 64);
+ *
+ * @param x0
+ *      Left coordinate of the window.
+ *
+ * @param y0
+ *      Top coordinate of the window.
+ *
+ * @param width
+ *      The width of the window.
+ *
+ * @param height
+ *      The height of the window.
+ *
+ * @return
+ *      A grid of the window, where cell (0, 0) is the cell (x0, y0) of the universe.
+ */
+Grid HashLife::to_grid(long long x0, long long y0, int width, int height) const {
+    Grid grid(width, height);
+    long long half = 1LL << (root->level - 1);
+    draw(root, -half, -half, grid, x0, y0);
+    return grid;
+}
+
+/**
+ * HashLife::draw(node, x0, y0, grid, gx, gy)
+ *
+ * Private helper function to write the alive cells of a node with its top left at (x0, y0)
+ * into a grid whose top left is at (gx, gy).
+ */
+void HashLife::draw(const Node *node, long long x0, long long y0, Grid &grid, long long gx, long long gy) const {
+    long long size = 1LL << node->level;
+    if (node->population == 0 || x0 >= gx + grid.get_width() || y0 >= gy + grid.get_height()
+            || x0 + size <= gx || y0 + size <= gy) {
+        return;
+    }
+    if (node->level == 0) {
+        grid.grid[(y0 - gy) * grid.get_width() + (x0 - gx)] = Cell::ALIVE;
+        return;
+    }
+    long long half = size / 2;
+    draw(node->nw, x0, y0, grid, gx, gy);
+    draw(node->ne, x0 + half, y0, grid, gx, gy);
+    draw(node->sw, x0, y0 + half, grid, gx, gy);
+    draw(node->se, x0 + half, y0 + half, grid, gx, gy);
+}
+
+/**
+ * HashLife::get(x, y)
+ *
+ * Returns the value of the cell at the desired coordinate of the universe.
+ *
+ * @param x
+ *      The x coordinate of the cell.
+ *
+ * @param y
+ *      The y coordinate of the cell.
+ *
+ * @return
+ *      The value of the cell. Cells outside the current extent of the universe are dead.
+ */
+Cell HashLife::get(long long x, long long y) const {
+    const Node *node = root;
+    long long half = 1LL << (node->level - 1);
+    if (x < -half || x >= half || y < -half || y >= half) {
+        return Cell::DEAD;
+    }
+    x += half;
+    y += half;
+    while (node->level > 0 && node->population > 0) {
+        long long quarter = 1LL << (node->level - 1);
+        bool east = x >= quarter, south = y >= quarter;
+        node = south ? (east ? node->se : node->sw) : (east ? node->ne : node->nw);
+        x -= east ? quarter : 0;
+        y -= south ? quarter : 0;
+    }
+    return node->population ? Cell::ALIVE : Cell::DEAD;
+}
+
+/**
+ * HashLife::copy(node, copies)
+ *
+ * Private helper function to rebuild a node of another universe in this universe.
+ */
+const HashLife::Node* HashLife::copy(const Node *node, std::unordered_map<const Node*, const Node*> &copies) {
+    if (node->level == 0) {
+        return leaf(node->population ? Cell::ALIVE : Cell::DEAD);
+    }
+    auto found = copies.find(node);
+    if (found != copies.end()) {
+        return found->second;
+    }
+    const Node *result = join(copy(node->nw, copies), copy(node->ne, copies),
+                              copy(node->sw, copies), copy(node->se, copies));
+    copies[node] = result;
+    return result;
+}
+
+/**
+ * HashLife::centre(node)
+ *
+ * Private helper function to get the centre square of a node, one level lower.
+ */
+const HashLife::Node* HashLife::centre(const Node *node) {
+    return join(node->nw->se, node->ne->sw, node->sw->ne, node->se->nw);
+}
+
+/**
+ * HashLife::expand(node)
+ *
+ * Private helper function to surround a node with dead cells, making a node one level higher
+ * with the original in its centre.
+ */
+const HashLife::Node* HashLife::expand(const Node *node) {
+    const Node *e = empty(node->level - 1);
+    return join(join(e, e, e, node->nw), join(e, e, node->ne, e),
+                join(e, node->sw, e, e), join(node->se, e, e, e));
+}
+
+/**
+ * HashLife::is_centred(node)
+ *
+ * Private helper function to check every alive cell of a node lies within its centre quarter,
+ * the square of half its size around its centre. A node passing this check can be advanced by a
+ * quarter of its size without any cell leaving the result.
+ */
+bool HashLife::is_centred(const Node *node) const {
+    if (node->level < 3) {
+        return false;
+    }
+    return node->nw->se->se->population + node->ne->sw->sw->population
+         + node->sw->ne->ne->population + node->se->nw->nw->population == node->population;
+}
+
+/**
+ * HashLife::step_4x4(node)
+ *
+ * Private helper function to advance the centre 2x2 cells of a 4x4 node by one generation,
+ * applying the rule directly.
+ */
+const HashLife::Node* HashLife::step_4x4(const Node *node) {
+    int cells[4][4];
+    const Node *quadrants[4] = {node->nw, node->ne, node->sw, node->se};
+    for (int q = 0; q < 4; q++) {
+        const Node *children[4] = {quadrants[q]->nw, quadrants[q]->ne, quadrants[q]->sw, quadrants[q]->se};
+        for (int c = 0; c < 4; c++) {
+            cells[(q / 2) * 2 + c / 2][(q % 2) * 2 + c % 2] = static_cast<int>(children[c]->population);
+        }
+    }
+
+    const Node *next[4];
+    for (int i = 0; i < 4; i++) {
+        int y = 1 + i / 2, x = 1 + i % 2;
+        int alive = cells[y - 1][x - 1] + cells[y - 1][x] + cells[y - 1][x + 1]
+                  + cells[y][x - 1] + cells[y][x + 1]
+                  + cells[y + 1][x - 1] + cells[y + 1][x] + cells[y + 1][x + 1];
+        next[i] = leaf(rule.next(cells[y][x] ? Cell::ALIVE : Cell::DEAD, alive));
+    }
+    return join(next[0], next[1], next[2], next[3]);
+}
+
+/**
+ * HashLife::successor(node, step)
+ *
+ * Private helper function to advance the centre of a node by 2^step generations, where step is at most level - 2.
+ *
+ * The node is split into nine overlapping sub-squares one level lower. When step is the largest possible,
+ * each sub-square is advanced by half the time, recombined into four squares, and advanced again.
+ * Otherwise each sub-square is advanced by the whole time and the four results are trimmed to their centres.
+ *
+ * Before anything new is computed the cache is garbage collected if it has passed the size set for the jump,
+ * see HashLife::advance(generations). The node and every sub-square and result still needed are kept in flight
+ * until the node is done, so a collection part way through a jump only frees the nodes it no longer needs.
+ *
+ * @return
+ *      The centre square of the node, one level lower, advanced by 2^step generations.
+ */
+const HashLife::Node* HashLife::successor(const Node *node, int step) {
+    if (node->population == 0) {
+        return empty(node->level - 1);
+    }
+    const bool full = (step == node->level - 2);
+    if (full && node->result) {
+        return node->result;
+    }
+    if (!full) {
+        auto found = steps.find(StepKey{node, step});
+        if (found != steps.end()) {
+            return found->second;
+        }
+    }
+
+    const std::size_t in_flight_size = in_flight.size();
+    in_flight.push_back(node);
+    const std::size_t usage = get_memory_usage();
+    peak_usage = std::max(peak_usage, usage);
+    if (usage > collect_at) {
+        collect_garbage();
+        collect_at = std::max(memory_limit, 2 * get_memory_usage());
+    }
+
+    const Node *result;
+    if (node->level == 2) {
+        result = step_4x4(node);
+    } else {
+        const Node *n00 = node->nw;
+        const Node *n01 = join(node->nw->ne, node->ne->nw, node->nw->se, node->ne->sw);
+        const Node *n02 = node->ne;
+        const Node *n10 = join(node->nw->sw, node->nw->se, node->sw->nw, node->sw->ne);
+        const Node *n11 = join(node->nw->se, node->ne->sw, node->sw->ne, node->se->nw);
+        const Node *n12 = join(node->ne->sw, node->ne->se, node->se->nw, node->se->ne);
+        const Node *n20 = node->sw;
+        const Node *n21 = join(node->sw->ne, node->se->nw, node->sw->se, node->se->sw);
+        const Node *n22 = node->se;
+        in_flight.insert(in_flight.end(), {n01, n10, n11, n12, n21});
+
+        // Every result is kept in flight as soon as it is made, as the next successor may collect garbage
+        const int inner = full ? step - 1 : step;
+        auto advanced = [&](const Node *square) {
+            const Node *next = successor(square, inner);
+            in_flight.push_back(next);
+            return next;
+        };
+        const Node *r00 = advanced(n00), *r01 = advanced(n01), *r02 = advanced(n02);
+        const Node *r10 = advanced(n10), *r11 = advanced(n11), *r12 = advanced(n12);
+        const Node *r20 = advanced(n20), *r21 = advanced(n21), *r22 = advanced(n22);
+        if (full) {
+            const Node *nw = advanced(join(r00, r01, r10, r11));
+            const Node *ne = advanced(join(r01, r02, r11, r12));
+            const Node *sw = advanced(join(r10, r11, r20, r21));
+            const Node *se = advanced(join(r11, r12, r21, r22));
+            result = join(nw, ne, sw, se);
+        } else {
+            result = join(centre(join(r00, r01, r10, r11)),
+                          centre(join(r01, r02, r11, r12)),
+                          centre(join(r10, r11, r20, r21)),
+                          centre(join(r11, r12, r21, r22)));
+        }
+    }
+
+    in_flight.resize(in_flight_size);
+    if (full) {
+        node->result = result;
+    } else {
+        steps[StepKey{node, step}] = result;
+    }
+    return result;
+}
+
+/**
+ * HashLife::advance(generations)
+ *
+ * Advance the universe by any number of generations, jumping by each power of two in the binary
+ * representation of the number. Before each jump the universe is padded with dead cells until it is
+ * large enough that nothing can escape it during the jump.
+ *
+ * If the node cache has grown past the memory limit it is garbage collected between jumps, and again during a jump
+ * whenever it passes the limit, see HashLife::successor(node, step). When the universe and the jump in progress
+ * alone fill the limit, the cache may grow to twice their size before the next collection, so that collecting
+ * does not take over from stepping.
+ *
+ * @example
+ *
+ *      // Advance a breeder by a billion generations
+ *      life.advance(1000000000);
+ *
+ * @param generations
+ *      The number of generations to advance.
+ */
+void HashLife::advance(unsigned long long generations) {
+    for (int step = 0; step < 64 && (generations >> step) != 0; step++) {
+        if (((generations >> step) & 1) == 0) {
+            continue;
+        }
+        while (root->level < step + 3 || !is_centred(root)) {
+            root = expand(root);
+        }
+        collect_at = memory_limit;
+        root = successor(root, step);
+        while (root->level < 3) {
+            root = expand(root);
+        }
+        generation += 1ULL << step;
+
+        if (get_memory_usage() > memory_limit) {
+            collect_garbage();
+        }
+    }
+}
+
+/**
+ * HashLife::set_rule(rule)
+ *
+ * Sets the rule the universe evolves under. Changing the rule forgets every memoised result,
+ * as they were computed under the old rule. The cells of the universe are kept.
+ *
+ * @example
+ *
+ *      // Run a pattern under HighLife
+ *      life.set_rule(Rule("B36/S23"));
+ *      life.advance(1 << 20);
+ *
+ * @param rule
+ *      The new rule.
+ *
+ * @throws
+ *      std::runtime_error or sub-class if the rule has births with 0 neighbours,
+ *      which would fill the infinite empty plane with alive cells.
+ */
+void HashLife::set_rule(const Rule &rule) {
+    if (rule.get_birth() & 1) {
+        throw std::runtime_error("Rules with B0 are not supported on an unbounded plane");
+    }
+    if (rule == this->rule) {
+        return;
+    }
+    this->rule = rule;
+    for (Node *node : nodes) {
+        node->result = nullptr;
+    }
+    steps.clear();
+}
+
+/**
+ * HashLife::get_rule()
+ *
+ * Gets the rule the universe evolves under, B3/S23 unless changed with HashLife::set_rule(rule).
+ *
+ * @return
+ *      The rule.
+ */
+const Rule& HashLife::get_rule() const {
+    return rule;
+}
+
+/**
+ * HashLife::get_alive_cells()
+ *
+ * Counts how many cells in the universe are alive.
+ *
+ * @return
+ *      The number of alive cells.
+ */
+std::uint64_t HashLife::get_alive_cells() const {
+    return root->population;
+}
+
+/**
+ * HashLife::get_generation()
+ *
+ * Gets the number of generations the universe has been advanced since it was last set.
+ *
+ * @return
+ *      The current generation.
+ */
+unsigned long long HashLife::get_generation() const {
+    return generation;
+}
+
+/**
+ * HashLife::get_node_count()
+ *
+ * Gets the number of canonical nodes in the cache.
+ *
+ * @return
+ *      The number of nodes.
+ */
+std::size_t HashLife::get_node_count() const {
+    return nodes.size();
+}
+
+/**
+ * HashLife::get_memory_usage()
+ *
+ * Estimates the memory used by the node cache and memoised results, including the hash table overhead.
+ *
+ * @return
+ *      The estimated size in bytes.
+ */
+std::size_t HashLife::get_memory_usage() const {
+    const std::size_t per_node = sizeof(Node) + 4 * sizeof(void*);
+    const std::size_t per_step = sizeof(StepKey) + 5 * sizeof(void*);
+    return nodes.size() * per_node + steps.size() * per_step;
+}
+
+/**
+ * HashLife::get_peak_memory_usage()
+ *
+ * Gets the largest estimated size the node cache has reached since the universe was last set,
+ * as measured each time a new result is computed.
+ *
+ * @example
+ *
+ *      // Check a long run stayed within its memory limit
+ *      HashLife life(soup, 64 << 20);
+ *      life.advance(1 << 20);
+ *      std::cout << life.get_peak_memory_usage() << " of " << life.get_memory_limit() << std::endl;
+ *
+ * @return
+ *      The estimated size in bytes.
+ */
+std::size_t HashLife::get_peak_memory_usage() const {
+    return peak_usage;
+}
+
+/**
+ * HashLife::get_memory_limit()
+ *
+ * Gets the size the node cache may reach before it is garbage collected.
+ *
+ * @return
+ *      The limit in bytes.
+ */
+std::size_t HashLife::get_memory_limit() const {
+    return memory_limit;
+}
+
+/**
+ * HashLife::set_memory_limit(bytes)
+ *
+ * Sets the size the node cache may reach before it is garbage collected.
+ * The limit is also kept during each jump, see HashLife::advance(generations).
+ *
+ * @param bytes
+ *      The limit in bytes.
+ */
+void HashLife::set_memory_limit(std::size_t bytes) {
+    memory_limit = bytes;
+}
+
+/**
+ * HashLife::collect_garbage()
+ *
+ * Frees every node not reachable from the current universe or a jump in progress, along with all memoised results
+ * that refer to freed nodes. Memoised results between surviving nodes are kept.
+ */
+void HashLife::collect_garbage() {
+    std::vector<const Node*> stack(empties.begin(), empties.end());
+    stack.insert(stack.end(), in_flight.begin(), in_flight.end());
+    stack.push_back(root);
+    while (!stack.empty()) {
+        const Node *node = stack.back();
+        stack.pop_back();
+        if (node->level == 0 || node->marked) {
+            continue;
+        }
+        node->marked = true;
+        stack.push_back(node->nw);
+        stack.push_back(node->ne);
+        stack.push_back(node->sw);
+        stack.push_back(node->se);
+    }
+
+    for (Node *node : nodes) {
+        if (node->marked && node->result && !node->result->marked) {
+            node->result = nullptr;
+        }
+    }
+    for (auto it = nodes.begin(); it != nodes.end(); ) {
+        Node *node = *it;
+        if (node->marked) {
+            node->marked = false;
+            ++it;
+        } else {
+            it = nodes.erase(it);
+            delete node;
+        }
+    }
+    steps.clear();
+}
@@ -0,0 +1,116 @@
+/**
+ * Declares a class representing an unbounded Game of Life universe simulated with the HashLife algorithm.
+ * Rich documentation for the api and behaviour the HashLife class can be found in hashlife.cpp.
+ *
+ * @author 959133
+ * @date March, 2020
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "grid.h"
+#include "rule.h"
+
+/**
+ * Declare the structure of the HashLife class for simulating an unbounded plane of cells as a quadtree.
+ *
+ * Every distinct square of cells is stored once as a canonical Node, and the future of each node is memoised,
+ * so repetitive patterns can be advanced by 2^k generations in a single jump.
+ */
+class HashLife {
+public:
+
+    /**
+     * A canonical square of 2^level by 2^level cells.
+     *      - Level 0 nodes are single cells with no children and a population of 0 or 1.
+     *      - Higher level nodes are made of four children one level lower.
+     *      - Nodes with the same children are the same node, so nodes can be compared by address.
+     */
+    struct Node {
+        const Node *nw, *ne, *sw, *se;
+        mutable const Node *result;
+        std::uint64_t population;
+        int level;
+        mutable bool marked;
+    };
+
+private:
+    struct NodeHash {
+        std::size_t operator()(const Node *node) const;
+    };
+    struct NodeEqual {
+        bool operator()(const Node *a, const Node *b) const;
+    };
+    struct StepKey {
+        const Node *node;
+        int step;
+        bool operator==(const StepKey &other) const;
+    };
+    struct StepKeyHash {
+        std::size_t operator()(const StepKey &key) const;
+    };
+
+    std::unordered_set<Node*, NodeHash, NodeEqual> nodes;
+    std::unordered_map<StepKey, const Node*, StepKeyHash> steps;
+    std::vector<const Node*> empties;
+    Node *dead_leaf;
+    Node *alive_leaf;
+
+    const Node *root;
+    unsigned long long generation;
+    std::size_t memory_limit;
+    // The nodes a jump in progress still needs, the size the cache may reach before it is collected
+    // during the jump, and the largest it has been
+    std::vector<const Node*> in_flight;
+    std::size_t collect_at;
+    std::size_t peak_usage;
+    Rule rule;
+
+    void release();
+    const Node* build(const Grid &grid, long long x0, long long y0, int level);
+    void draw(const Node *node, long long x0, long long y0, Grid &grid, long long gx, long long gy) const;
+    const Node* copy(const Node *node, std::unordered_map<const Node*, const Node*> &copies);
+    const Node* centre(const Node *node);
+    const Node* expand(const Node *node);
+    bool is_centred(const Node *node) const;
+    const Node* step_4x4(const Node *node);
+    const Node* successor(const Node *node, int step);
+
+public:
+    static const std::size_t DEFAULT_MEMORY_LIMIT = std::size_t(1) << 30;
+
+    explicit HashLife(std::size_t memory_limit = DEFAULT_MEMORY_LIMIT);
+    explicit HashLife(const Grid &grid, std::size_t memory_limit = DEFAULT_MEMORY_LIMIT);
+    HashLife(const HashLife &other);
+    HashLife(HashLife &&other);
+    HashLife& operator=(HashLife other);
+    ~HashLife();
+
+    void swap(HashLife &other);
+
+    void set_grid(const Grid &grid);
+    Grid to_grid(long long x0, long long y0, int width, int height) const;
+    Cell get(long long x, long long y) const;
+
+    void advance(unsigned long long generations);
+    void set_rule(const Rule &rule);
+    const Rule& get_rule() const;
+
+    std::uint64_t get_alive_cells() const;
+    unsigned long long get_generation() const;
+    std::size_t get_node_count() const;
+    std::size_t get_memory_usage() const;
+    std::size_t get_peak_memory_usage() const;
+    std::size_t get_memory_limit() const;
+    void set_memory_limit(std::size_t bytes);
+    void collect_garbage();
+
+    const Node* leaf(Cell value) const;
+    const Node* empty(int level);
+    const Node* join(const Node *nw, const Node *ne, const Node *sw, const Node *se);
+    const Node* get_root() const;
+    void set_root(const Node *node);
+};
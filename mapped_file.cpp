@@ -0,0 +1,233 @@
+/**
+ * Implements a class for reading a file through memory mapped windows.
+ *      - A window maps a byte range of the file straight into memory with mmap, so reading it costs no copy
+ *        and the pages are filled by the kernel as they are touched.
+ *      - Windows are advised as sequential, letting the kernel read ahead and drop pages behind the reader.
+ *        Windows read in scattered pieces can be advised as random instead, so only the pages touched are read.
+ *      - Unmapping a window releases it, so a large file can be streamed through a series of small windows
+ *        without ever being resident in memory as a whole.
+ *      - On platforms without mmap each window is read into a buffer with std::ifstream instead.
+ *
+ * @author 959133
+ * @date March, 2020
+ */
+#include "mapped_file.h"
+
+#include <stdexcept>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define GOL_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#endif
+
+/**
+ * MappedFile::Window::Window()
+ *
+ * Private constructor for an empty window. Windows are made by MappedFile::map(offset, length).
+ */
+MappedFile::Window::Window() : base(nullptr), base_length(0), bytes(nullptr), length(0) {
+}
+
+/**
+ * MappedFile::Window::Window(other)
+ *
+ * Construct a window by taking the mapping of another, leaving the other empty.
+ *
+ * @param other
+ *      The window to move from.
+ */
+MappedFile::Window::Window(Window &&other) : Window() {
+    *this = std::move(other);
+}
+
+/**
+ * MappedFile::Window::operator=(other)
+ *
+ * Unmaps this window and takes the mapping of another, leaving the other empty.
+ *
+ * @param other
+ *      The window to move from.
+ *
+ * @return
+ *      A reference to this window.
+ */
+MappedFile::Window& MappedFile::Window::operator=(Window &&other) {
+    std::swap(base, other.base);
+    std::swap(base_length, other.base_length);
+    std::swap(buffer, other.buffer);
+    std::swap(bytes, other.bytes);
+    std::swap(length, other.length);
+    return *this;
+}
+
+/**
+ * MappedFile::Window::~Window()
+ *
+ * Unmaps the window.
+ */
+MappedFile::Window::~Window() {
+#ifdef GOL_HAVE_MMAP
+    if (base) {
+        munmap(base, base_length);
+    }
+#endif
+}
+
+/**
+ * MappedFile::Window::data()
+ *
+ * Gets the bytes of the window.
+ *
+ * @return
+ *      A pointer to the first byte of the range the window was mapped for.
+ */
+const unsigned char* MappedFile::Window::data() const {
+    return bytes;
+}
+
+/**
+ * MappedFile::Window::get_size()
+ *
+ * Gets the number of bytes in the window.
+ *
+ * @return
+ *      The length of the range the window was mapped for.
+ */
+std::size_t MappedFile::Window::get_size() const {
+    return length;
+}
+
+/**
+ * MappedFile::MappedFile(path)
+ *
+ * Open a file for reading through mapped windows.
+ *
+ * @example
+ *
+ *      // Sum the bytes of a file, 64 MiB at a time
+ *      MappedFile file("path/to/file.bgol");
+ *      std::uint64_t sum = 0;
+ *      for (std::uint64_t offset = 0; offset < file.get_size(); offset += 64 << 20) {
+ *          MappedFile::Window window = file.map(offset, std::min<std::uint64_t>(64 << 20, file.get_size() - offset));
+ *          for (std::size_t i = 0; i < window.get_size(); i++) {
+ *              sum += window.data()[i];
+ *          }
+ *      }
+ *
+ * @param path
+ *      The std::string path to the file to read.
+ *
+ * @throws
+ *      std::runtime_error or sub-class if the file cannot be opened.
+ */
+MappedFile::MappedFile(const std::string &path) : path(path), fd(-1), size(0) {
+#ifdef GOL_HAVE_MMAP
+    fd = open(path.c_str(), O_RDONLY);
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) != 0) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        throw std::runtime_error("File cannot be opened");
+    }
+    size = static_cast<std::uint64_t>(info.st_size);
+#else
+    std::ifstream file(path, std::ios_base::binary | std::ios_base::ate);
+    if (!file) {
+        throw std::runtime_error("File cannot be opened");
+    }
+    size = static_cast<std::uint64_t>(file.tellg());
+#endif
+}
+
+/**
+ * MappedFile::~MappedFile()
+ *
+ * Closes the file. Windows already mapped stay valid.
+ */
+MappedFile::~MappedFile() {
+#ifdef GOL_HAVE_MMAP
+    if (fd >= 0) {
+        close(fd);
+    }
+#endif
+}
+
+/**
+ * MappedFile::get_size()
+ *
+ * Gets the size of the file.
+ *
+ * @return
+ *      The size of the file in bytes.
+ */
+std::uint64_t MappedFile::get_size() const {
+    return size;
+}
+
+/**
+ * MappedFile::map(offset, length, access)
+ *
+ * Maps a byte range of the file into memory. The mapping starts on the page holding the offset,
+ * which is hidden from the caller.
+ *
+ * @param offset
+ *      The position of the first byte to map.
+ *
+ * @param length
+ *      The number of bytes to map.
+ *
+ * @param access
+ *      Optional parameter. Access::RANDOM if only scattered parts of the window will be read,
+ *      stopping the kernel reading ahead. Defaults to Access::SEQUENTIAL.
+ *
+ * @return
+ *      A window onto the bytes [offset, offset + length) of the file.
+ *
+ * @throws
+ *      std::runtime_error or sub-class if:
+ *          - The range runs past the end of the file.
+ *          - The range cannot be mapped.
+ */
+MappedFile::Window MappedFile::map(std::uint64_t offset, std::size_t length, Access access) const {
+    if (offset > size || length > size - offset) {
+        throw std::runtime_error("File ends unexpectedly");
+    }
+    Window window;
+    if (length == 0) {
+        return window;
+    }
+
+#ifdef GOL_HAVE_MMAP
+    static const std::uint64_t page = static_cast<std::uint64_t>(sysconf(_SC_PAGESIZE));
+    const std::uint64_t start = offset - offset % page;
+    const std::size_t lead = static_cast<std::size_t>(offset - start);
+
+    void *base = mmap(nullptr, length + lead, PROT_READ, MAP_PRIVATE, fd, static_cast<off_t>(start));
+    if (base == MAP_FAILED) {
+        throw std::runtime_error("File cannot be mapped");
+    }
+    madvise(base, length + lead, (access == Access::RANDOM) ? MADV_RANDOM : MADV_SEQUENTIAL);
+
+    window.base = base;
+    window.base_length = length + lead;
+    window.bytes = static_cast<const unsigned char*>(base) + lead;
+#else
+    (void) access;
+    std::ifstream file(path, std::ios_base::binary);
+    window.buffer.resize(length);
+    file.seekg(static_cast<std::streamoff>(offset));
+    if (!file.read(reinterpret_cast<char*>(window.buffer.data()), static_cast<std::streamsize>(length))) {
+        throw std::runtime_error("File ends unexpectedly");
+    }
+    window.bytes = window.buffer.data();
+#endif
+    window.length = length;
+    return window;
+}
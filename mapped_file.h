@@ -0,0 +1,64 @@
+/**
+ * Declares a class for reading a file through memory mapped windows.
+ * Rich documentation for the api and behaviour the MappedFile class can be found in mapped_file.cpp.
+ *
+ * @author 959133
+ * @date March, 2020
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Declare the structure of the MappedFile class for reading byte ranges of a file without copying them.
+ *
+ * Only one window of the file needs to be mapped at a time, so files larger than memory can be streamed.
+ */
+class MappedFile {
+private:
+    std::string path;
+    int fd;
+    std::uint64_t size;
+
+public:
+
+    /**
+     * How a window is expected to be read, passed on to the kernel to guide read ahead.
+     */
+    enum class Access { SEQUENTIAL, RANDOM };
+
+    /**
+     * A read-only view of a byte range of a MappedFile, unmapped when destroyed.
+     */
+    class Window {
+    private:
+        void *base;
+        std::size_t base_length;
+        std::vector<unsigned char> buffer;
+        const unsigned char *bytes;
+        std::size_t length;
+
+        friend class MappedFile;
+        Window();
+
+    public:
+        Window(Window &&other);
+        Window& operator=(Window &&other);
+        Window(const Window &) = delete;
+        Window& operator=(const Window &) = delete;
+        ~Window();
+
+        const unsigned char* data() const;
+        std::size_t get_size() const;
+    };
+
+    explicit MappedFile(const std::string &path);
+    MappedFile(const MappedFile &) = delete;
+    MappedFile& operator=(const MappedFile &) = delete;
+    ~MappedFile();
+
+    std::uint64_t get_size() const;
+    Window map(std::uint64_t offset, std::size_t length, Access access = Access::SEQUENTIAL) const;
+};
@@ -0,0 +1,275 @@
+/**
+ * Implements a Numa namespace for placing threads and memory on the nodes of a multi-socket machine.
+ *      - The nodes and their CPUs are read once from sysfs, keeping only the CPUs this process may run on.
+ *      - Threads can be pinned to a single CPU, or released back to every CPU the process started with.
+ *      - The CPUs a thread may run on can be saved, and restored later.
+ *      - Ranges of memory can be bound to a node with the mbind system call, moving any pages already
+ *        touched, so a buffer first written by one thread can still live next to the threads that use it.
+ *      - Elsewhere, or when sysfs cannot be read, the machine is treated as a single node and pinning and
+ *        binding do nothing.
+ *
+ * @author 959133
+ * @date March, 2020
+ */
+#include "numa.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#if defined(__linux__)
+#define GOL_HAVE_NUMA 1
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifdef GOL_HAVE_NUMA
+// From linux/mempolicy.h, which is not always installed
+static const int MPOL_PREFERRED_MODE = 1;
+static const unsigned MPOL_MF_MOVE_FLAG = 1 << 1;
+
+/**
+ * allowed_cpus()
+ *
+ * Gets the CPUs the process was allowed to run on when first asked, before any thread was pinned.
+ */
+static const cpu_set_t& allowed_cpus() {
+    static const cpu_set_t allowed = [] {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+                CPU_SET(cpu, &set);
+            }
+        }
+        return set;
+    }();
+    return allowed;
+}
+#endif
+
+/**
+ * parse_list(text)
+ *
+ * Parses a sysfs list of numbers and ranges, i.e. "0-3,8,10-11".
+ */
+static std::vector<int> parse_list(const std::string &text) {
+    std::vector<int> values;
+    std::istringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        int first, last;
+        char dash;
+        std::istringstream range(item);
+        if (!(range >> first)) {
+            continue;
+        }
+        last = (range >> dash >> last && dash == '-') ? last : first;
+        for (int value = first; value <= last; value++) {
+            values.push_back(value);
+        }
+    }
+    return values;
+}
+
+/**
+ * read_list(path)
+ *
+ * Reads a sysfs list file, giving an empty list if the file cannot be read.
+ */
+static std::vector<int> read_list(const std::string &path) {
+    std::ifstream file(path);
+    std::string text;
+    std::getline(file, text);
+    return parse_list(text);
+}
+
+/**
+ * Numa::topology()
+ *
+ * Gets the memory nodes of the machine that have CPUs this process may run on. The result is read once and cached.
+ *
+ * @example
+ *
+ *      // Print the CPUs of each node
+ *      for (const Numa::Node &node : Numa::topology()) {
+ *          std::cout << "Node " << node.id << ":";
+ *          for (int cpu : node.cpus) {
+ *              std::cout << " " << cpu;
+ *          }
+ *          std::cout << std::endl;
+ *      }
+ *
+ * @return
+ *      The nodes in order of id. Never empty, a machine without NUMA support is one node holding every CPU.
+ */
+const std::vector<Numa::Node>& Numa::topology() {
+    static const std::vector<Node> nodes = [] {
+        std::vector<Node> found;
+#ifdef GOL_HAVE_NUMA
+        for (int id : read_list("/sys/devices/system/node/online")) {
+            Node node{id, {}};
+            for (int cpu : read_list("/sys/devices/system/node/node" + std::to_string(id) + "/cpulist")) {
+                if (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed_cpus())) {
+                    node.cpus.push_back(cpu);
+                }
+            }
+            if (!node.cpus.empty()) {
+                found.push_back(node);
+            }
+        }
+#endif
+        if (found.empty()) {
+            Node node{0, {}};
+            const int cpus = std::max(1u, std::thread::hardware_concurrency());
+            for (int cpu = 0; cpu < cpus; cpu++) {
+                node.cpus.push_back(cpu);
+            }
+            found.push_back(node);
+        }
+        return found;
+    }();
+    return nodes;
+}
+
+/**
+ * Numa::pin_thread(cpu)
+ *
+ * Pins the calling thread to run on one CPU only, or releases it to run on any CPU the process could at first.
+ *
+ * @example
+ *
+ *      // Keep this thread on the first CPU of the last node
+ *      Numa::pin_thread(Numa::topology().back().cpus.front());
+ *
+ * @param cpu
+ *      The CPU to run on, or -1 to release the thread.
+ *
+ * @return
+ *      True if the affinity was set.
+ */
+bool Numa::pin_thread(int cpu) {
+#ifdef GOL_HAVE_NUMA
+    if (cpu >= CPU_SETSIZE) {
+        return false;
+    }
+    cpu_set_t set = allowed_cpus();
+    if (cpu >= 0) {
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void) cpu;
+    return false;
+#endif
+}
+
+/**
+ * Numa::get_affinity()
+ *
+ * Gets the CPUs the calling thread may run on, so they can be restored with Numa::set_affinity(cpus).
+ *
+ * @example
+ *
+ *      // Pin this thread for a while, then put it back as it was
+ *      const std::vector<int> saved = Numa::get_affinity();
+ *      Numa::pin_thread(0);
+ *      ...
+ *      Numa::set_affinity(saved);
+ *
+ * @return
+ *      The CPUs in ascending order, or an empty list if they cannot be read.
+ */
+std::vector<int> Numa::get_affinity() {
+    std::vector<int> cpus;
+#ifdef GOL_HAVE_NUMA
+    cpu_set_t set;
+    if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &set)) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+#endif
+    return cpus;
+}
+
+/**
+ * Numa::set_affinity(cpus)
+ *
+ * Sets the CPUs the calling thread may run on.
+ *
+ * @param cpus
+ *      The CPUs to allow, i.e. as returned by Numa::get_affinity(). An empty list does nothing.
+ *
+ * @return
+ *      True if the affinity was set.
+ */
+bool Numa::set_affinity(const std::vector<int> &cpus) {
+#ifdef GOL_HAVE_NUMA
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    return CPU_COUNT(&set) > 0 && pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void) cpus;
+    return false;
+#endif
+}
+
+/**
+ * Numa::bind(address, bytes, node)
+ *
+ * Asks for a range of memory to be placed on a node, moving the pages that are already in memory.
+ * Only whole pages inside the range are bound, so neighbouring ranges bound to different nodes never share a page.
+ * The node is preferred rather than required, so memory still comes from another node once it is full.
+ *
+ * @example
+ *
+ *      // Place the second half of a buffer on node 1
+ *      Numa::bind(buffer.data() + buffer.size() / 2, buffer.size() / 2, 1);
+ *
+ * @param address
+ *      The first byte of the range.
+ *
+ * @param bytes
+ *      The length of the range in bytes.
+ *
+ * @param node
+ *      The id of the node, see Numa::topology().
+ *
+ * @return
+ *      True if the range was bound, or held no whole page.
+ */
+bool Numa::bind(const void *address, std::size_t bytes, int node) {
+#ifdef GOL_HAVE_NUMA
+    static const std::uintptr_t page = static_cast<std::uintptr_t>(sysconf(_SC_PAGESIZE));
+    const std::uintptr_t begin = (reinterpret_cast<std::uintptr_t>(address) + page - 1) / page * page;
+    const std::uintptr_t end = (reinterpret_cast<std::uintptr_t>(address) + bytes) / page * page;
+    if (node < 0 || begin >= end) {
+        return node >= 0;
+    }
+
+    const std::size_t bits = 8 * sizeof(unsigned long);
+    std::vector<unsigned long> mask(node / bits + 1, 0);
+    mask[node / bits] = 1UL << (node % bits);
+    return syscall(SYS_mbind, reinterpret_cast<void*>(begin), end - begin, MPOL_PREFERRED_MODE,
+                   mask.data(), mask.size() * bits + 1, MPOL_MF_MOVE_FLAG) == 0;
+#else
+    (void) address;
+    (void) bytes;
+    (void) node;
+    return false;
+#endif
+}
@@ -0,0 +1,42 @@
+/**
+ * Declares a Numa namespace for placing threads and memory on the nodes of a multi-socket machine.
+ * Rich documentation for the api and behaviour the Numa namespace can be found in numa.cpp.
+ *
+ * @author 959133
+ * @date March, 2020
+ */
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+/**
+ * Declare the interface of the Numa namespace for finding the memory nodes, pinning threads, and binding memory.
+ */
+namespace Numa {
+
+    /**
+     * A memory node and the CPUs attached to it that this process may run on.
+     */
+    struct Node {
+        int id;
+        std::vector<int> cpus;
+    };
+
+    /**
+     * The work done by the threads pinned to one node, see World::get_node_stats().
+     */
+    struct NodeStats {
+        int node;
+        int threads;
+        long long tasks;
+        long long items;
+        std::chrono::nanoseconds busy;
+    };
+
+    const std::vector<Node>& topology();
+    bool pin_thread(int cpu);
+    std::vector<int> get_affinity();
+    bool set_affinity(const std::vector<int> &cpus);
+    bool bind(const void *address, std::size_t bytes, int node);
+};
@@ -0,0 +1,238 @@
+/**
+ * Implements a class representing a life-like cellular automaton rule in B/S notation.
+ * https://www.conwaylife.com/wiki/Rulestring
+ *
+ *      - A rule lists the neighbour counts for which a dead cell is born (B) and an alive cell survives (S).
+ *          - Conway's Game of Life is B3/S23, HighLife is B36/S23, Seeds is B2/S.
+ *      - Rules can be parsed from and printed to a rulestring.
+ *          - B/S notation is accepted in any case and either order, i.e. "B3/S23", "b3s23", or "S23/B3".
+ *          - The older S/B notation of two digit lists is also accepted, i.e. "23/3".
+ *          - The names "Life" and "HighLife" are accepted in any case, as written by Golly.
+ *      - The default rule is Conway's Game of Life.
+ *
+ * @author 959133
+ * @date March, 2020
+ */
+#include "rule.h"
+
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+
+/**
+ * named_rule(rulestring)
+ *
+ * Gives the rulestring of a rule written by name, or the rulestring unchanged if it is not a known name.
+ */
+static std::string named_rule(const std::string &rulestring) {
+    std::string lower(rulestring);
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+    if (lower == "life") {
+        return "B3/S23";
+    }
+    if (lower == "highlife") {
+        return "B36/S23";
+    }
+    return rulestring;
+}
+
+/**
+ * Rule::Rule()
+ *
+ * Construct the rule for Conway's Game of Life, B3/S23.
+ *
+ * @example
+ *
+ *      // Make the standard rule
+ *      Rule rule;
+ *
+ */
+Rule::Rule() : Rule(1u << 3, (1u << 2) | (1u << 3)) {
+}
+
+/**
+ * Rule::Rule(birth, survival)
+ *
+ * Construct a rule from neighbour count masks.
+ *
+ * @example
+ *
+ *      // Make HighLife, B36/S23
+ *      Rule highlife((1 << 3) | (1 << 6), (1 << 2) | (1 << 3));
+ *
+ * @param birth
+ *      A mask where bit n is set if a dead cell with n alive neighbours is born.
+ *
+ * @param survival
+ *      A mask where bit n is set if an alive cell with n alive neighbours survives.
+ *
+ * @throws
+ *      std::runtime_error or sub-class if a mask has bits set above bit 8.
+ */
+Rule::Rule(unsigned birth, unsigned survival) : birth(birth), survival(survival) {
+    if ((birth | survival) >> 9) {
+        throw std::runtime_error("Neighbour counts must be between 0 and 8");
+    }
+}
+
+/**
+ * Rule::Rule(rulestring)
+ *
+ * Construct a rule by parsing a rulestring.
+ *
+ * @example
+ *
+ *      // Make HighLife
+ *      Rule highlife("B36/S23");
+ *
+ *      // Make Seeds, where no cell survives
+ *      Rule seeds("B2/S");
+ *
+ *      // Make Conway's Game of Life by name
+ *      Rule life("Life");
+ *
+ * @param rulestring
+ *      The rule in B/S or S/B notation, or "Life" or "HighLife".
+ *
+ * @throws
+ *      std::runtime_error or sub-class if the rulestring is malformed.
+ */
+Rule::Rule(const std::string &rulestring) : birth(0), survival(0) {
+    const std::string malformed = "Malformed rule: " + rulestring;
+    const std::string notation = named_rule(rulestring);
+
+    bool lettered = false;
+    for (char c : notation) {
+        if (c == 'B' || c == 'b' || c == 'S' || c == 's') {
+            lettered = true;
+        }
+    }
+
+    // Without letters the rule is in S/B notation, the survival counts coming first
+    unsigned *target = lettered ? nullptr : &survival;
+    bool seen_birth = false, seen_survival = !lettered, seen_slash = false;
+    for (char c : notation) {
+        char upper = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        if (upper == 'B' && lettered && !seen_birth) {
+            target = &birth;
+            seen_birth = true;
+        } else if (upper == 'S' && lettered && !(seen_survival && target == &survival)) {
+            target = &survival;
+            seen_survival = true;
+        } else if (c == '/' && !seen_slash) {
+            seen_slash = true;
+            if (!lettered) {
+                target = &birth;
+            }
+        } else if (c >= '0' && c <= '8' && target) {
+            *target |= 1u << (c - '0');
+        } else {
+            throw std::runtime_error(malformed);
+        }
+    }
+    if (lettered ? !(seen_birth && seen_survival) : !seen_slash) {
+        throw std::runtime_error(malformed);
+    }
+}
+
+/**
+ * Rule::get_birth()
+ *
+ * Gets the neighbour counts for which a dead cell is born.
+ *
+ * @return
+ *      A mask where bit n is set if a dead cell with n alive neighbours is born.
+ */
+unsigned Rule::get_birth() const {
+    return birth;
+}
+
+/**
+ * Rule::get_survival()
+ *
+ * Gets the neighbour counts for which an alive cell survives.
+ *
+ * @return
+ *      A mask where bit n is set if an alive cell with n alive neighbours survives.
+ */
+unsigned Rule::get_survival() const {
+    return survival;
+}
+
+/**
+ * Rule::next(cell, alive)
+ *
+ * Applies the rule to a single cell.
+ *
+ * @example
+ *
+ *      // A dead cell with three neighbours is born in Conway's Game of Life
+ *      Cell cell = Rule().next(Cell::DEAD, 3);
+ *
+ * @param cell
+ *      The current value of the cell.
+ *
+ * @param alive
+ *      The number of alive neighbours of the cell, from 0 to 8.
+ *
+ * @return
+ *      The value of the cell in the next step.
+ */
+Cell Rule::next(Cell cell, int alive) const {
+    unsigned counts = (cell == Cell::ALIVE) ? survival : birth;
+    return ((counts >> alive) & 1) ? Cell::ALIVE : Cell::DEAD;
+}
+
+/**
+ * Rule::to_string()
+ *
+ * Prints the rule in B/S notation.
+ *
+ * @example
+ *
+ *      // Prints B3/S23
+ *      std::cout << Rule().to_string() << std::endl;
+ *
+ * @return
+ *      The rulestring.
+ */
+std::string Rule::to_string() const {
+    std::string rulestring = "B";
+    for (int n = 0; n <= 8; n++) {
+        if ((birth >> n) & 1) {
+            rulestring += static_cast<char>('0' + n);
+        }
+    }
+    rulestring += "/S";
+    for (int n = 0; n <= 8; n++) {
+        if ((survival >> n) & 1) {
+            rulestring += static_cast<char>('0' + n);
+        }
+    }
+    return rulestring;
+}
+
+/**
+ * Rule::operator==(other)
+ *
+ * Compares two rules.
+ *
+ * @return
+ *      True if both rules have the same birth and survival counts.
+ */
+bool Rule::operator==(const Rule &other) const {
+    return birth == other.birth && survival == other.survival;
+}
+
+/**
+ * Rule::operator!=(other)
+ *
+ * Compares two rules.
+ *
+ * @return
+ *      True if the rules differ in their birth or survival counts.
+ */
+bool Rule::operator!=(const Rule &other) const {
+    return !operator==(other);
+}
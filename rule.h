@@ -0,0 +1,35 @@
+/**
+ * Declares a class representing a life-like cellular automaton rule in B/S notation.
+ * Rich documentation for the api and behaviour the Rule class can be found in rule.cpp.
+ *
+ * @author 959133
+ * @date March, 2020
+ */
+#pragma once
+#include <string>
+#include "grid.h"
+
+/**
+ * Declare the structure of the Rule class for representing which neighbour counts cause a dead cell
+ * to be born and an alive cell to survive.
+ *
+ * Counts are stored as 9 bit masks, where bit n is set if a count of n neighbours applies.
+ */
+class Rule {
+private:
+    unsigned birth;
+    unsigned survival;
+
+public:
+    Rule();
+    Rule(unsigned birth, unsigned survival);
+    explicit Rule(const std::string &rulestring);
+
+    unsigned get_birth() const;
+    unsigned get_survival() const;
+    Cell next(Cell cell, int alive) const;
+    std::string to_string() const;
+
+    bool operator==(const Rule &other) const;
+    bool operator!=(const Rule &other) const;
+};
@@ -0,0 +1,37 @@
+/**
+ * Declares a Simd namespace with vectorized kernels for stepping rows of byte-per-cell Grid storage.
+ * Rich documentation for the api and behaviour the Simd namespace can be found in simd.cpp.
+ *
+ * @author 959133
+ * @date March, 2020
+ */
+#pragma once
+#include "grid.h"
+
+/**
+ * Declare the interface of the Simd namespace for selecting and running vectorized row kernels.
+ */
+namespace Simd {
+
+    /**
+     * The instruction set levels a kernel can be built for, from slowest to fastest.
+     */
+    enum class Level {
+        SCALAR,
+        SSE2,
+        AVX2,
+        AVX512
+    };
+
+    /**
+     * A row kernel computes the next state of the cells [x0, x1) of the row mid,
+     * reading the cells x0-1 to x1 (inclusive) of the rows up, mid, and down,
+     * using the birth and survival neighbour count masks of a Rule.
+     */
+    typedef void (*RowKernel)(const Cell *up, const Cell *mid, const Cell *down, Cell *out, int x0, int x1,
+                              unsigned birth, unsigned survival);
+
+    Level detect();
+    const char* name(Level level);
+    RowKernel get_kernel(Level level);
+};
@@ -0,0 +1,494 @@
+/**
+ * Implements a class representing an unbounded 2d world stored as a sparse map of tiles.
+ *      - The plane is split into 64x64 tiles, each stored as 64 words of one bit per cell.
+ *      - Tiles are kept in a hash map keyed by their tile coordinates, and only tiles with alive cells are kept,
+ *        so a pattern can grow in any direction without pre-sizing a dense buffer.
+ *      - Stepping visits the stored tiles and the neighbouring tiles their edge cells can reach,
+ *        computing 64 cells per word with the same full-adder logic as the packed World engine.
+ *      - The bounding box of the alive cells can be queried and any window exported as a Grid.
+ *
+ * @author 959133
+ * @date March, 2020
+ */
+#include "sparse_world.h"
+#include "bitgrid.h"
+#include "swar.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * floor_div(value, divisor)
+ *
+ * Divides rounding towards negative infinity, so negative coordinates land in the correct tile.
+ */
+static inline long long floor_div(long long value, long long divisor) {
+    return (value >= 0) ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+/**
+ * SparseWorld::TileKeyHash::operator()(key)
+ *
+ * Hashes a pair of tile coordinates, mixing the bits so that neighbouring tiles spread over the map.
+ */
+std::size_t SparseWorld::TileKeyHash::operator()(const TileKey &key) const {
+    std::uint64_t hash = static_cast<std::uint64_t>(key.first) * 0x9E3779B97F4A7C15ull;
+    hash = (hash ^ static_cast<std::uint64_t>(key.second)) * 0xBF58476D1CE4E5B9ull;
+    return static_cast<std::size_t>(hash ^ (hash >> 31));
+}
+
+/**
+ * SparseWorld::key(tx, ty)
+ *
+ * Private helper function to make the map key of a pair of tile coordinates.
+ */
+SparseWorld::TileKey SparseWorld::key(long long tx, long long ty) {
+    return TileKey(tx, ty);
+}
+
+/**
+ * SparseWorld::tile_x(key)
+ *
+ * Private helper function to get the x tile coordinate of a map key.
+ */
+long long SparseWorld::tile_x(const TileKey &key) {
+    return key.first;
+}
+
+/**
+ * SparseWorld::tile_y(key)
+ *
+ * Private helper function to get the y tile coordinate of a map key.
+ */
+long long SparseWorld::tile_y(const TileKey &key) {
+    return key.second;
+}
+
+/**
+ * SparseWorld::find(tx, ty)
+ *
+ * Private helper function to look up a tile.
+ *
+ * @return
+ *      The tile, or nullptr if it holds no alive cells.
+ */
+const SparseWorld::Tile* SparseWorld::find(long long tx, long long ty) const {
+    auto found = tiles.find(key(tx, ty));
+    return (found == tiles.end()) ? nullptr : &found->second;
+}
+
+/**
+ * SparseWorld::SparseWorld()
+ *
+ * Construct an empty unbounded world.
+ *
+ * @example
+ *
+ *      // Make an empty plane and place a glider on it
+ *      SparseWorld world;
+ *      world.set(0, 0, Cell::ALIVE);
+ *
+ */
+SparseWorld::SparseWorld() : generation(0) {
+}
+
+/**
+ * SparseWorld::SparseWorld(grid, x0, y0)
+ *
+ * Construct an unbounded world holding the alive cells of a grid.
+ *
+ * @example
+ *
+ *      // Place an r-pentomino on an unbounded plane
+ *      SparseWorld world(Zoo::r_pentomino());
+ *
+ * @param grid
+ *      The grid of cells to place on the plane.
+ *
+ * @param x0
+ *      Optional parameter. The x coordinate of the top left cell of the grid. Defaults to 0.
+ *
+ * @param y0
+ *      Optional parameter. The y coordinate of the top left cell of the grid. Defaults to 0.
+ */
+SparseWorld::SparseWorld(const Grid &grid, long long x0, long long y0) : SparseWorld() {
+    for (int y = 0; y < grid.get_height(); y++) {
+        for (int x = 0; x < grid.get_width(); x++) {
+            if (grid.grid[static_cast<std::size_t>(y) * grid.get_width() + x] == Cell::ALIVE) {
+                set(x0 + x, y0 + y, Cell::ALIVE);
+            }
+        }
+    }
+}
+
+/**
+ * SparseWorld::get(x, y)
+ *
+ * Returns the value of the cell at the desired coordinate. Every coordinate is valid.
+ *
+ * @param x
+ *      The x coordinate of the cell.
+ *
+ * @param y
+ *      The y coordinate of the cell.
+ *
+ * @return
+ *      The value of the cell.
+ */
+Cell SparseWorld::get(long long x, long long y) const {
+    long long tx = floor_div(x, TILE_SIZE), ty = floor_div(y, TILE_SIZE);
+    const Tile *tile = find(tx, ty);
+    if (!tile) {
+        return Cell::DEAD;
+    }
+    return ((tile->rows[y - ty * TILE_SIZE] >> (x - tx * TILE_SIZE)) & 1) ? Cell::ALIVE : Cell::DEAD;
+}
+
+/**
+ * SparseWorld::set(x, y, value)
+ *
+ * Overwrites the value of the cell at the desired coordinate, allocating its tile if needed
+ * and releasing the tile once it has no alive cells.
+ *
+ * @param x
+ *      The x coordinate of the cell.
+ *
+ * @param y
+ *      The y coordinate of the cell.
+ *
+ * @param value
+ *      The value to be written to the cell.
+ */
+void SparseWorld::set(long long x, long long y, Cell value) {
+    long long tx = floor_div(x, TILE_SIZE), ty = floor_div(y, TILE_SIZE);
+    std::uint64_t bit = std::uint64_t(1) << (x - tx * TILE_SIZE);
+    int row = static_cast<int>(y - ty * TILE_SIZE);
+
+    if (value == Cell::ALIVE) {
+        auto inserted = tiles.emplace(key(tx, ty), Tile());
+        if (inserted.second) {
+            std::fill(std::begin(inserted.first->second.rows), std::end(inserted.first->second.rows), 0);
+        }
+        inserted.first->second.rows[row] |= bit;
+        return;
+    }
+
+    auto found = tiles.find(key(tx, ty));
+    if (found == tiles.end()) {
+        return;
+    }
+    found->second.rows[row] &= ~bit;
+    const std::uint64_t *rows = found->second.rows;
+    if (std::all_of(rows, rows + TILE_SIZE, [](std::uint64_t word) { return word == 0; })) {
+        tiles.erase(found);
+    }
+}
+
+/**
+ * SparseWorld::clear()
+ *
+ * Kills every cell and resets the generation counter.
+ */
+void SparseWorld::clear() {
+    tiles.clear();
+    generation = 0;
+}
+
+/**
+ * SparseWorld::get_alive_cells()
+ *
+ * Counts how many cells in the world are alive.
+ *
+ * @return
+ *      The number of alive cells.
+ */
+long long SparseWorld::get_alive_cells() const {
+    long long alive = 0;
+    for (const auto &entry : tiles) {
+        for (std::uint64_t word : entry.second.rows) {
+            alive += popcount64(word);
+        }
+    }
+    return alive;
+}
+
+/**
+ * SparseWorld::get_generation()
+ *
+ * Gets the number of steps taken since the world was constructed or cleared.
+ *
+ * @return
+ *      The current generation.
+ */
+long long SparseWorld::get_generation() const {
+    return generation;
+}
+
+/**
+ * SparseWorld::get_tile_count()
+ *
+ * Gets the number of allocated tiles, each of which holds at least one alive cell.
+ *
+ * @return
+ *      The number of tiles.
+ */
+int SparseWorld::get_tile_count() const {
+    return static_cast<int>(tiles.size());
+}
+
+/**
+ * SparseWorld::get_bounding_box(x0, y0, x1, y1)
+ *
+ * Finds the smallest rectangle [x0, x1) by [y0, y1) containing every alive cell.
+ *
+ * @example
+ *
+ *      // Export exactly the live part of the world
+ *      long long x0, y0, x1, y1;
+ *      if (world.get_bounding_box(x0, y0, x1, y1)) {
+ *          Grid grid = world.to_grid(x0, y0, x1, y1);
+ *      }
+ *
+ * @return
+ *      True if there are any alive cells, otherwise false and the coordinates are left unchanged.
+ */
+bool SparseWorld::get_bounding_box(long long &x0, long long &y0, long long &x1, long long &y1) const {
+    long long min_x = std::numeric_limits<long long>::max(), min_y = min_x;
+    long long max_x = std::numeric_limits<long long>::min(), max_y = max_x;
+    for (const auto &entry : tiles) {
+        long long left = tile_x(entry.first) * TILE_SIZE, top = tile_y(entry.first) * TILE_SIZE;
+        std::uint64_t columns = 0;
+        for (int row = 0; row < TILE_SIZE; row++) {
+            if (entry.second.rows[row]) {
+                min_y = std::min(min_y, top + row);
+                max_y = std::max(max_y, top + row);
+                columns |= entry.second.rows[row];
+            }
+        }
+        if (columns) {
+            int low = 0, high = TILE_SIZE - 1;
+            while (!((columns >> low) & 1)) {
+                low++;
+            }
+            while (!((columns >> high) & 1)) {
+                high--;
+            }
+            min_x = std::min(min_x, left + low);
+            max_x = std::max(max_x, left + high);
+        }
+    }
+    if (min_x > max_x) {
+        return false;
+    }
+    x0 = min_x;
+    y0 = min_y;
+    x1 = max_x + 1;
+    y1 = max_y + 1;
+    return true;
+}
+
+/**
+ * SparseWorld::to_grid(x0, y0, x1, y1)
+ *
+ * Exports a window of the world spanning [x0, x1) by [y0, y1) as a grid, in the same way as Grid::crop.
+ * Only the tiles overlapping the window are visited.
+ *
+ * @example
+ *
+ *      // Snapshot the 100x100 cells right and below the origin
+ *      Grid grid = world.to_grid(0, 0, 100, 100);
+ *
+ * @return
+ *      A new grid of the window, where cell (0, 0) is the cell (x0, y0) of the world.
+ *
+ * @throws
+ *      std::runtime_error or sub-class if the window has a negative size.
+ */
+Grid SparseWorld::to_grid(long long x0, long long y0, long long x1, long long y1) const {
+    if (x1 < x0 || y1 < y0) {
+        throw std::runtime_error("Window has a negative size");
+    }
+    Grid grid(static_cast<int>(x1 - x0), static_cast<int>(y1 - y0));
+
+    auto draw = [&](long long tx, long long ty, const Tile &tile) {
+        for (int row = 0; row < TILE_SIZE; row++) {
+            long long y = ty * TILE_SIZE + row;
+            if (y < y0 || y >= y1 || tile.rows[row] == 0) {
+                continue;
+            }
+            for (int bit = 0; bit < TILE_SIZE; bit++) {
+                long long x = tx * TILE_SIZE + bit;
+                if (x >= x0 && x < x1 && ((tile.rows[row] >> bit) & 1)) {
+                    grid.grid[static_cast<std::size_t>(y - y0) * grid.get_width() + (x - x0)] = Cell::ALIVE;
+                }
+            }
+        }
+    };
+
+    long long tx0 = floor_div(x0, TILE_SIZE), tx1 = floor_div(x1 - 1, TILE_SIZE);
+    long long ty0 = floor_div(y0, TILE_SIZE), ty1 = floor_div(y1 - 1, TILE_SIZE);
+    if ((tx1 - tx0 + 1) * (ty1 - ty0 + 1) < static_cast<long long>(tiles.size())) {
+        for (long long ty = ty0; ty <= ty1; ty++) {
+            for (long long tx = tx0; tx <= tx1; tx++) {
+                if (const Tile *tile = find(tx, ty)) {
+                    draw(tx, ty, *tile);
+                }
+            }
+        }
+    } else {
+        for (const auto &entry : tiles) {
+            draw(tile_x(entry.first), tile_y(entry.first), entry.second);
+        }
+    }
+    return grid;
+}
+
+/**
+ * SparseWorld::set_rule(rule)
+ *
+ * Sets the rule the plane evolves under. The cells are kept.
+ *
+ * @example
+ *
+ *      // Grow a pattern under Seeds
+ *      sparse.set_rule(Rule("B2/S"));
+ *
+ * @param rule
+ *      The new rule.
+ *
+ * @throws
+ *      std::runtime_error or sub-class if the rule has births with 0 neighbours,
+ *      which would fill the infinite empty plane with alive cells.
+ */
+void SparseWorld::set_rule(const Rule &rule) {
+    if (rule.get_birth() & 1) {
+        throw std::runtime_error("Rules with B0 are not supported on an unbounded plane");
+    }
+    this->rule = rule;
+}
+
+/**
+ * SparseWorld::get_rule()
+ *
+ * Gets the rule the plane evolves under, B3/S23 unless changed with SparseWorld::set_rule(rule).
+ *
+ * @return
+ *      The rule.
+ */
+const Rule& SparseWorld::get_rule() const {
+    return rule;
+}
+
+/**
+ * TileKernel<Birth, Survival>::run(block, out, birth, survival)
+ *
+ * Computes the next state of the centre tile of a 3x3 block of tiles, specialised for a rule.
+ * See select_rule_kernel() in swar.h.
+ *
+ * @return
+ *      True if the next state of the tile has alive cells.
+ */
+template <unsigned Birth, unsigned Survival>
+struct TileKernel {
+    static bool run(const SparseWorld::Tile *const block[3][3], SparseWorld::Tile &out,
+                    unsigned birth, unsigned survival) {
+        const int size = SparseWorld::TILE_SIZE;
+
+        // Reads row y (from -1 to 64) of the centre tile, with its west and east neighbour words
+        auto read = [&](int y, std::uint64_t &w, std::uint64_t &c, std::uint64_t &e) {
+            int by = (y < 0) ? 0 : (y >= size ? 2 : 1);
+            int row = y - (by - 1) * size;
+            c = block[by][1]->rows[row];
+            w = (c << 1) | (block[by][0]->rows[row] >> 63);
+            e = (c >> 1) | (block[by][2]->rows[row] << 63);
+        };
+
+        std::uint64_t any = 0;
+        for (int row = 0; row < size; row++) {
+            std::uint64_t nw, n, ne, w, c, e, sw, s, se;
+            read(row - 1, nw, n, ne);
+            read(row, w, c, e);
+            read(row + 1, sw, s, se);
+            out.rows[row] = next_generation<Birth, Survival>(nw, n, ne, w, c, e, sw, s, se, birth, survival);
+            any |= out.rows[row];
+        }
+        return any != 0;
+    }
+};
+
+/**
+ * SparseWorld::step()
+ *
+ * Take one step on the unbounded plane under the rule of the world.
+ *
+ * Every stored tile is a candidate for the next state, along with each neighbouring tile that one of its
+ * edge rows or columns could give birth in. Each candidate is computed from its 3x3 block of tiles,
+ * reading missing tiles as dead, and only kept if it has alive cells.
+ */
+void SparseWorld::step() {
+    static const Tile dead_tile = Tile();
+
+    std::vector<TileKey> candidates;
+    candidates.reserve(tiles.size() * 3);
+    for (const auto &entry : tiles) {
+        long long tx = tile_x(entry.first), ty = tile_y(entry.first);
+        const std::uint64_t *rows = entry.second.rows;
+        std::uint64_t columns = 0;
+        for (int row = 0; row < TILE_SIZE; row++) {
+            columns |= rows[row];
+        }
+        bool top = rows[0] != 0, bottom = rows[TILE_SIZE - 1] != 0;
+        bool left = (columns & 1) != 0, right = (columns >> (TILE_SIZE - 1)) != 0;
+
+        candidates.push_back(entry.first);
+        if (top) candidates.push_back(key(tx, ty - 1));
+        if (bottom) candidates.push_back(key(tx, ty + 1));
+        if (left) candidates.push_back(key(tx - 1, ty));
+        if (right) candidates.push_back(key(tx + 1, ty));
+        if (top && left) candidates.push_back(key(tx - 1, ty - 1));
+        if (top && right) candidates.push_back(key(tx + 1, ty - 1));
+        if (bottom && left) candidates.push_back(key(tx - 1, ty + 1));
+        if (bottom && right) candidates.push_back(key(tx + 1, ty + 1));
+    }
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    const auto kernel = select_rule_kernel<TileKernel>(rule.get_birth(), rule.get_survival());
+    std::unordered_map<TileKey, Tile, TileKeyHash> next;
+    next.reserve(candidates.size());
+    for (const TileKey &candidate : candidates) {
+        long long tx = tile_x(candidate), ty = tile_y(candidate);
+        const Tile *block[3][3];
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                const Tile *tile = find(tx + dx, ty + dy);
+                block[dy + 1][dx + 1] = tile ? tile : &dead_tile;
+            }
+        }
+
+        Tile tile;
+        if (kernel(block, tile, rule.get_birth(), rule.get_survival())) {
+            next.emplace(candidate, tile);
+        }
+    }
+
+    tiles.swap(next);
+    generation++;
+}
+
+/**
+ * SparseWorld::advance(steps)
+ *
+ * Advance multiple steps on the unbounded plane.
+ * Should be implemented by invoking SparseWorld::step().
+ *
+ * @param steps
+ *      The number of steps to advance the world forward.
+ */
+void SparseWorld::advance(int steps) {
+    for (int i = 0; i < steps; i++) {
+        step();
+    }
+}
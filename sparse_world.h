@@ -0,0 +1,68 @@
+/**
+ * Declares a class representing an unbounded 2d world stored as a sparse map of tiles.
+ * Rich documentation for the api and behaviour the SparseWorld class can be found in sparse_world.cpp.
+ *
+ * @author 959133
+ * @date March, 2020
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include "grid.h"
+#include "rule.h"
+
+/**
+ * Declare the structure of the SparseWorld class for simulating an unbounded plane of cells.
+ *
+ * The plane is split into 64x64 tiles keyed by their tile coordinates. Only tiles holding at least one
+ * alive cell are stored, so memory follows the population rather than the area the pattern spans.
+ */
+class SparseWorld {
+public:
+    static const int TILE_SIZE = 64;
+
+    /**
+     * A 64x64 square of cells, one bit per cell, bit x of row y holding the cell (x, y) of the tile.
+     */
+    struct Tile {
+        std::uint64_t rows[TILE_SIZE];
+    };
+
+private:
+    // Tile coordinates are kept whole, so every cell a long long can address has a tile of its own
+    typedef std::pair<long long, long long> TileKey;
+    struct TileKeyHash {
+        std::size_t operator()(const TileKey &key) const;
+    };
+
+    std::unordered_map<TileKey, Tile, TileKeyHash> tiles;
+    long long generation;
+    Rule rule;
+
+    static TileKey key(long long tx, long long ty);
+    static long long tile_x(const TileKey &key);
+    static long long tile_y(const TileKey &key);
+    const Tile* find(long long tx, long long ty) const;
+
+public:
+    SparseWorld();
+    explicit SparseWorld(const Grid &grid, long long x0 = 0, long long y0 = 0);
+
+    Cell get(long long x, long long y) const;
+    void set(long long x, long long y, Cell value);
+    void clear();
+
+    long long get_alive_cells() const;
+    long long get_generation() const;
+    int get_tile_count() const;
+    bool get_bounding_box(long long &x0, long long &y0, long long &x1, long long &y1) const;
+    Grid to_grid(long long x0, long long y0, long long x1, long long y1) const;
+
+    void set_rule(const Rule &rule);
+    const Rule& get_rule() const;
+
+    void step();
+    void advance(int steps);
+};
@@ -0,0 +1,134 @@
+/**
+ * Declares the bit-parallel (SWAR, SIMD within a register) building blocks shared by the word-at-a-time engines.
+ * Each 64 bit word holds 64 cells, one per bit, and every bitwise operation updates all of them at once.
+ *
+ * The rule is a pair of template parameters so the common rules compile to a handful of instructions,
+ * with RUNTIME_RULE selecting a generic kernel that reads the birth and survival masks at runtime.
+ * See select_rule_kernel() for dispatching a Rule to a specialised kernel.
+ *
+ * @author 959133
+ * @date March, 2020
+ */
+#pragma once
+#include <cstdint>
+
+/**
+ * Template argument selecting the generic kernel, which takes the birth and survival masks at runtime.
+ */
+static const unsigned RUNTIME_RULE = ~0u;
+
+/**
+ * next_generation<Birth, Survival>(nw, n, ne, w, c, e, sw, s, se, birth, survival)
+ *
+ * Applies a rule to 64 cells at once. Each argument holds, for every bit, the state of
+ * that neighbour (or the cell itself for c). The eight neighbours are summed into a 4 bit count
+ * per cell using bitwise full adders, then the cells whose count is listed by the rule are selected.
+ *
+ * Birth and Survival are neighbour count masks, bit n set if a count of n applies. With constant masks the
+ * loop over counts unrolls and every unused count folds away. With RUNTIME_RULE the masks birth and survival
+ * are used instead.
+ *
+ * @return
+ *      The next state of the 64 cells.
+ */
+template <unsigned Birth, unsigned Survival>
+inline std::uint64_t next_generation(std::uint64_t nw, std::uint64_t n, std::uint64_t ne,
+                                     std::uint64_t w,  std::uint64_t c, std::uint64_t e,
+                                     std::uint64_t sw, std::uint64_t s, std::uint64_t se,
+                                     unsigned birth = 0, unsigned survival = 0) {
+    const unsigned born_counts = (Birth == RUNTIME_RULE) ? birth : Birth;
+    const unsigned kept_counts = (Survival == RUNTIME_RULE) ? survival : Survival;
+
+    // Add up each row of neighbours into 2 bit sums
+    std::uint64_t up0 = nw ^ n ^ ne,  up1 = (nw & n) | (ne & (nw ^ n));
+    std::uint64_t down0 = sw ^ s ^ se, down1 = (sw & s) | (se & (sw ^ s));
+    std::uint64_t mid0 = w ^ e,        mid1 = w & e;
+
+    // Add the three row sums into a 4 bit count, bits0 + 2*bits1 + 4*bits2 + 8*bits3
+    std::uint64_t bits0 = up0 ^ down0 ^ mid0;
+    std::uint64_t carry0 = (up0 & down0) | (mid0 & (up0 ^ down0));
+    std::uint64_t twos = up1 ^ down1 ^ mid1;
+    std::uint64_t carry1 = (up1 & down1) | (mid1 & (up1 ^ down1));
+    std::uint64_t bits1 = twos ^ carry0;
+    std::uint64_t carry2 = twos & carry0;
+    std::uint64_t bits2 = carry1 ^ carry2;
+    std::uint64_t bits3 = carry1 & carry2;
+
+    // Select the cells whose count matches one listed by the rule
+    std::uint64_t born = 0, kept = 0;
+    for (unsigned count = 0; count <= 8; count++) {
+        if (((born_counts | kept_counts) >> count) & 1) {
+            std::uint64_t match = ((count & 1) ? bits0 : ~bits0) & ((count & 2) ? bits1 : ~bits1)
+                                & ((count & 4) ? bits2 : ~bits2) & ((count & 8) ? bits3 : ~bits3);
+            if ((born_counts >> count) & 1) {
+                born |= match;
+            }
+            if ((kept_counts >> count) & 1) {
+                kept |= match;
+            }
+        }
+    }
+    return (born & ~c) | (kept & c);
+}
+
+/**
+ * next_generation<B3, S23>(nw, n, ne, w, c, e, sw, s, se)
+ *
+ * Hand simplified kernel for Conway's Game of Life, alive next step with a count of 3,
+ * or a count of 2 when already alive.
+ */
+template <>
+inline std::uint64_t next_generation<1u << 3, (1u << 2) | (1u << 3)>(
+        std::uint64_t nw, std::uint64_t n, std::uint64_t ne,
+        std::uint64_t w,  std::uint64_t c, std::uint64_t e,
+        std::uint64_t sw, std::uint64_t s, std::uint64_t se, unsigned, unsigned) {
+    std::uint64_t up0 = nw ^ n ^ ne,  up1 = (nw & n) | (ne & (nw ^ n));
+    std::uint64_t down0 = sw ^ s ^ se, down1 = (sw & s) | (se & (sw ^ s));
+    std::uint64_t mid0 = w ^ e,        mid1 = w & e;
+
+    std::uint64_t bits0 = up0 ^ down0 ^ mid0;
+    std::uint64_t carry0 = (up0 & down0) | (mid0 & (up0 ^ down0));
+    std::uint64_t twos = up1 ^ down1 ^ mid1;
+    std::uint64_t carry1 = (up1 & down1) | (mid1 & (up1 ^ down1));
+    std::uint64_t bits1 = twos ^ carry0;
+    std::uint64_t carry2 = twos & carry0;
+    std::uint64_t bits2 = carry1 ^ carry2;
+    std::uint64_t bits3 = carry1 & carry2;
+
+    return bits1 & ~bits2 & ~bits3 & (bits0 | c);
+}
+
+/**
+ * select_rule_kernel<Kernel>(birth, survival)
+ *
+ * Picks the instantiation of a kernel template specialised for a rule. Kernel is a class template
+ * taking the birth and survival masks, with a static function run. The common named rules get their
+ * own instantiation, any other rule falls back to Kernel<RUNTIME_RULE, RUNTIME_RULE>.
+ *
+ * @example
+ *
+ *      template <unsigned Birth, unsigned Survival>
+ *      struct RowKernel {
+ *          static void run(const std::uint64_t *row, unsigned birth, unsigned survival);
+ *      };
+ *
+ *      // Step with the kernel for HighLife
+ *      auto kernel = select_rule_kernel<RowKernel>(rule.get_birth(), rule.get_survival());
+ *      kernel(row, rule.get_birth(), rule.get_survival());
+ *
+ * @return
+ *      A pointer to the run function of the chosen instantiation.
+ */
+template <template <unsigned, unsigned> class Kernel>
+inline decltype(&Kernel<RUNTIME_RULE, RUNTIME_RULE>::run) select_rule_kernel(unsigned birth, unsigned survival) {
+    #define GOL_RULE_KERNEL(B, S) if (birth == (B) && survival == (S)) return &Kernel<(B), (S)>::run
+    GOL_RULE_KERNEL(0x008, 0x00C);  // B3/S23, Conway's Game of Life
+    GOL_RULE_KERNEL(0x048, 0x00C);  // B36/S23, HighLife
+    GOL_RULE_KERNEL(0x004, 0x000);  // B2/S, Seeds
+    GOL_RULE_KERNEL(0x1C8, 0x1D8);  // B3678/S34678, Day & Night
+    GOL_RULE_KERNEL(0x0AA, 0x0AA);  // B1357/S1357, Replicator
+    GOL_RULE_KERNEL(0x148, 0x034);  // B368/S245, Morley
+    GOL_RULE_KERNEL(0x008, 0x1FF);  // B3/S012345678, Life without Death
+    #undef GOL_RULE_KERNEL
+    return &Kernel<RUNTIME_RULE, RUNTIME_RULE>::run;
+}
@@ -0,0 +1,305 @@
+/**
+ * Implements a class for watching a grid change in place in a terminal.
+ *      - Each frame is drawn over the last using ANSI escape codes to move the cursor, rather than scrolling.
+ *          - Only characters that changed since the previous frame are written, so a mostly still grid
+ *            costs a few bytes per frame.
+ *          - A status line below the grid is rewritten when it changes.
+ *      - A viewport picks the part of the grid drawn, by default sized to fit the terminal.
+ *      - Cells can be drawn one per character, or 2x4 to a character as Unicode braille dots.
+ *      - Frames can be capped to a rate, so a fast simulation is not held back by a slow terminal or connection.
+ *
+ * @author 959133
+ * @date March, 2020
+ */
+#include "terminal_view.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define GOL_HAVE_WINSIZE 1
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+/**
+ * UNDRAWN
+ *
+ * Marks a character of the previous frame as unknown, so it is always written.
+ * Drawn characters hold a cell value or a pattern of 8 braille dots, both below 256.
+ */
+static const std::uint16_t UNDRAWN = 0xFFFF;
+
+/**
+ * terminal_size(columns, rows)
+ *
+ * Gets the size of the terminal attached to standard output, falling back to the COLUMNS and LINES
+ * environment variables, then 80x24.
+ */
+static void terminal_size(int &columns, int &rows) {
+#ifdef GOL_HAVE_WINSIZE
+    struct winsize size;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_col > 0 && size.ws_row > 0) {
+        columns = size.ws_col;
+        rows = size.ws_row;
+        return;
+    }
+#endif
+    const char *env_columns = std::getenv("COLUMNS");
+    const char *env_rows = std::getenv("LINES");
+    columns = env_columns ? std::atoi(env_columns) : 0;
+    rows = env_rows ? std::atoi(env_rows) : 0;
+    columns = (columns > 0) ? columns : 80;
+    rows = (rows > 0) ? rows : 24;
+}
+
+/**
+ * append_braille(text, dots)
+ *
+ * Appends the UTF-8 encoding of the braille character U+2800 + dots.
+ * A character with no dots is written as a space, which is shorter and renders the same.
+ */
+static void append_braille(std::string &text, unsigned dots) {
+    if (dots == 0) {
+        text += ' ';
+        return;
+    }
+    text += static_cast<char>(0xE2);
+    text += static_cast<char>(0xA0 | (dots >> 6));
+    text += static_cast<char>(0x80 | (dots & 0x3F));
+}
+
+/**
+ * TerminalView::TerminalView(output_stream, braille)
+ *
+ * Construct a view drawing to a terminal, with a viewport at the top left of the grid sized to fit the terminal,
+ * and no cap on the frame rate.
+ *
+ * @example
+ *
+ *      // Watch a world evolve in the terminal
+ *      TerminalView view(std::cout);
+ *      for (int step = 0; step < 1000; step++) {
+ *          world.step();
+ *          view.draw(world.get_state(), "Step " + std::to_string(step));
+ *      }
+ *      view.close();
+ *
+ * @param output_stream
+ *      The stream connected to the terminal, such as std::cout.
+ *
+ * @param braille
+ *      Optional parameter. True to draw each 2x4 block of cells as one braille character. Defaults to false.
+ */
+TerminalView::TerminalView(std::ostream &output_stream, bool braille)
+        : output_stream(output_stream), braille(braille), x0(0), y0(0), columns(0), rows(0),
+          interval(std::chrono::steady_clock::duration::zero()), last_draw(),
+          drawn(false), frame_columns(0), frame_rows(0) {
+}
+
+/**
+ * TerminalView::~TerminalView()
+ *
+ * Closes the view, see TerminalView::close().
+ */
+TerminalView::~TerminalView() {
+    close();
+}
+
+/**
+ * TerminalView::set_viewport(x0, y0, columns, rows)
+ *
+ * Sets the part of the grid that is drawn.
+ *
+ * @example
+ *
+ *      // Draw a 100x40 character window onto the middle of a large grid
+ *      view.set_viewport(grid.get_width() / 2 - 50, grid.get_height() / 2 - 20, 100, 40);
+ *
+ * @param x0
+ *      The x coordinate of the cell drawn at the top left of the terminal.
+ *
+ * @param y0
+ *      The y coordinate of the cell drawn at the top left of the terminal.
+ *
+ * @param columns
+ *      Optional parameter. The width of the viewport in characters, or 0 to fit the terminal. Defaults to 0.
+ *
+ * @param rows
+ *      Optional parameter. The height of the viewport in characters, or 0 to fit the terminal
+ *      above the status line. Defaults to 0.
+ */
+void TerminalView::set_viewport(int x0, int y0, int columns, int rows) {
+    this->x0 = std::max(0, x0);
+    this->y0 = std::max(0, y0);
+    this->columns = std::max(0, columns);
+    this->rows = std::max(0, rows);
+}
+
+/**
+ * TerminalView::set_frame_rate(frames_per_second)
+ *
+ * Caps how often a frame is due, see TerminalView::is_due().
+ *
+ * @param frames_per_second
+ *      The most frames to draw each second, or 0 for no cap.
+ */
+void TerminalView::set_frame_rate(int frames_per_second) {
+    interval = (frames_per_second > 0)
+        ? std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::seconds(1)) / frames_per_second
+        : std::chrono::steady_clock::duration::zero();
+}
+
+/**
+ * TerminalView::is_due()
+ *
+ * Tests whether enough time has passed since the last frame to draw another within the frame rate.
+ * Frames that are not due can be skipped, including the cost of getting the state to draw.
+ *
+ * @example
+ *
+ *      // Step as fast as possible, drawing at most 30 frames a second
+ *      view.set_frame_rate(30);
+ *      while (true) {
+ *          world.step();
+ *          if (view.is_due()) {
+ *              view.draw(world.get_state());
+ *          }
+ *      }
+ *
+ * @return
+ *      True if a frame is due.
+ */
+bool TerminalView::is_due() const {
+    return !drawn || std::chrono::steady_clock::now() - last_draw >= interval;
+}
+
+/**
+ * TerminalView::move_to(row, column)
+ *
+ * Appends the escape code moving the cursor to a 0-based row and column of the terminal.
+ */
+void TerminalView::move_to(int row, int column) {
+    text += "\x1b[";
+    text += std::to_string(row + 1);
+    text += ';';
+    text += std::to_string(column + 1);
+    text += 'H';
+}
+
+/**
+ * TerminalView::draw(grid, status)
+ *
+ * Draws the part of a grid within the viewport, and a status line beneath it.
+ *
+ * The first frame, and any frame after the viewport or terminal changes size, clears the screen and draws
+ * every character. Later frames compare each character with the one drawn before, and write only those
+ * that changed, moving the cursor over runs that did not. The frame is built in a buffer kept between calls
+ * and written with a single call.
+ *
+ * @param grid
+ *      The grid to draw.
+ *
+ * @param status
+ *      Optional parameter. A line of text drawn below the grid. Defaults to empty.
+ */
+void TerminalView::draw(const Grid &grid, const std::string &status) {
+    int screen_columns = columns, screen_rows = rows;
+    if (screen_columns == 0 || screen_rows == 0) {
+        int terminal_columns, terminal_rows;
+        terminal_size(terminal_columns, terminal_rows);
+        screen_columns = screen_columns ? screen_columns : terminal_columns;
+        screen_rows = screen_rows ? screen_rows : std::max(1, terminal_rows - 1);
+    }
+
+    // Clip the viewport to the characters that show part of the grid
+    const int cell_columns = braille ? 2 : 1;
+    const int cell_rows = braille ? 4 : 1;
+    const int width = grid.get_width();
+    const int height = grid.get_height();
+    const int visible_columns = std::min(screen_columns, (std::max(0, width - x0) + cell_columns - 1) / cell_columns);
+    const int visible_rows = std::min(screen_rows, (std::max(0, height - y0) + cell_rows - 1) / cell_rows);
+
+    text.clear();
+    if (!drawn || visible_columns != frame_columns || visible_rows != frame_rows) {
+        text += "\x1b[?25l\x1b[H\x1b[2J";
+        frame_columns = visible_columns;
+        frame_rows = visible_rows;
+        previous.assign(static_cast<std::size_t>(visible_columns) * visible_rows, UNDRAWN);
+        previous_status.clear();
+        drawn = true;
+    }
+
+    const Cell *cells = grid.grid.data();
+    int cursor_row = -1, cursor_column = -1;
+    for (int row = 0; row < visible_rows; row++) {
+        for (int column = 0; column < visible_columns; column++) {
+            const int x = x0 + column * cell_columns;
+            const int y = y0 + row * cell_rows;
+            std::uint16_t value;
+            if (braille) {
+                // Dots 1-3 and 7 run down the left column, dots 4-6 and 8 the right
+                static const unsigned dot[4][2] = {{0x01, 0x08}, {0x02, 0x10}, {0x04, 0x20}, {0x40, 0x80}};
+                unsigned dots = 0;
+                for (int dy = 0; dy < 4 && y + dy < height; dy++) {
+                    const Cell *line = cells + static_cast<std::size_t>(y + dy) * width;
+                    for (int dx = 0; dx < 2 && x + dx < width; dx++) {
+                        if (line[x + dx] == Cell::ALIVE) {
+                            dots |= dot[dy][dx];
+                        }
+                    }
+                }
+                value = static_cast<std::uint16_t>(dots);
+            } else {
+                value = static_cast<unsigned char>(cells[static_cast<std::size_t>(y) * width + x]);
+            }
+
+            std::uint16_t &shown = previous[static_cast<std::size_t>(row) * visible_columns + column];
+            if (shown == value) {
+                continue;
+            }
+            shown = value;
+            if (row != cursor_row || column != cursor_column) {
+                move_to(row, column);
+            }
+            if (braille) {
+                append_braille(text, value);
+            } else {
+                text += static_cast<char>(value);
+            }
+            cursor_row = row;
+            cursor_column = column + 1;
+        }
+    }
+
+    // Long status lines are cut to the width of the screen rather than wrapped
+    const std::string line = status.substr(0, static_cast<std::size_t>(screen_columns));
+    if (line != previous_status) {
+        move_to(visible_rows, 0);
+        text += line;
+        text += "\x1b[K";
+        previous_status = line;
+    }
+
+    output_stream.write(text.data(), static_cast<std::streamsize>(text.size()));
+    output_stream.flush();
+    last_draw = std::chrono::steady_clock::now();
+}
+
+/**
+ * TerminalView::close()
+ *
+ * Moves the cursor below the last frame and shows it again, so later output follows on beneath the view.
+ * The next frame drawn starts afresh by clearing the screen.
+ */
+void TerminalView::close() {
+    if (!drawn) {
+        return;
+    }
+    text.clear();
+    move_to(frame_rows + 1, 0);
+    text += "\x1b[?25h";
+    output_stream.write(text.data(), static_cast<std::streamsize>(text.size()));
+    output_stream.flush();
+    drawn = false;
+}
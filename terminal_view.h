@@ -0,0 +1,55 @@
+/**
+ * Declares a class for watching a grid change in place in a terminal.
+ * Rich documentation for the api and behaviour the TerminalView class can be found in terminal_view.cpp.
+ *
+ * @author 959133
+ * @date March, 2020
+ */
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "grid.h"
+
+/**
+ * Declare the structure of the TerminalView class for drawing successive states of a grid to an ANSI terminal.
+ *
+ * Only the characters that differ from the previous frame are written, and only the part of the grid
+ * within the viewport is drawn, so the output per frame is bounded by the size of the terminal.
+ */
+class TerminalView {
+private:
+    std::ostream &output_stream;
+    bool braille;
+    int x0;
+    int y0;
+    int columns;
+    int rows;
+    std::chrono::steady_clock::duration interval;
+    std::chrono::steady_clock::time_point last_draw;
+
+    bool drawn;
+    int frame_columns;
+    int frame_rows;
+    std::vector<std::uint16_t> previous;
+    std::string previous_status;
+    std::string text;
+
+    void move_to(int row, int column);
+
+public:
+    explicit TerminalView(std::ostream &output_stream, bool braille = false);
+    TerminalView(const TerminalView &) = delete;
+    TerminalView& operator=(const TerminalView &) = delete;
+    ~TerminalView();
+
+    void set_viewport(int x0, int y0, int columns = 0, int rows = 0);
+    void set_frame_rate(int frames_per_second);
+    bool is_due() const;
+
+    void draw(const Grid &grid, const std::string &status = "");
+    void close();
+};
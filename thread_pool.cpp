@@ -0,0 +1,362 @@
+/**
+ * Implements a class representing a persistent pool of worker threads.
+ *      - Worker threads are started once and sleep on a condition variable between tasks.
+ *      - The calling thread takes part in every task as thread 0, so a pool of N threads starts N-1 workers.
+ *      - A range of work can be split into one contiguous band per thread.
+ *      - A range of uneven work can instead be split into many small tasks, scheduled by work stealing.
+ *          - Each thread starts with a contiguous share of the tasks in its own queue, and takes them from the front.
+ *          - A thread with an empty queue steals the back half of the queue of another thread,
+ *            trying the threads on its own memory node first when the nodes of the threads are set.
+ *          - The tasks run, the steals, and the time spent running tasks are counted for each thread.
+ *      - An exception thrown by a task on any thread is rethrown on the calling thread.
+ *
+ * @author 959133
+ * @date March, 2020
+ */
+#include "thread_pool.h"
+
+#include <algorithm>
+
+/**
+ * ThreadPool::ThreadPool(threads)
+ *
+ * Construct a pool that runs tasks on the desired number of threads, including the calling thread.
+ *
+ * @example
+ *
+ *      // Make a pool using every hardware thread
+ *      ThreadPool pool(std::thread::hardware_concurrency());
+ *
+ * @param threads
+ *      The number of threads to run each task on. Values below 1 are treated as 1.
+ */
+ThreadPool::ThreadPool(int threads)
+        : queues(std::max(threads, 1)), queued(0), task(nullptr), round(0), pending(0), stopping(false) {
+    set_nodes({});
+    reset_stats();
+    for (int i = 1; i < threads; i++) {
+        workers.emplace_back(&ThreadPool::work, this, i);
+    }
+}
+
+/**
+ * ThreadPool::~ThreadPool()
+ *
+ * Wakes and joins every worker thread.
+ */
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    start.notify_all();
+    for (auto &worker : workers) {
+        worker.join();
+    }
+}
+
+/**
+ * ThreadPool::get_threads()
+ *
+ * Gets the number of threads each task is run on, including the calling thread.
+ *
+ * @return
+ *      The number of threads.
+ */
+int ThreadPool::get_threads() const {
+    return static_cast<int>(workers.size()) + 1;
+}
+
+/**
+ * ThreadPool::work(index)
+ *
+ * Private loop run by each worker thread. Sleeps until a new round of work is started,
+ * runs the task with its thread index, and reports back when finished.
+ *
+ * @param index
+ *      The index of this worker, from 1 to ThreadPool::get_threads() - 1.
+ */
+void ThreadPool::work(int index) {
+    unsigned long seen = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        start.wait(lock, [&] { return stopping || round != seen; });
+        if (stopping) {
+            return;
+        }
+        seen = round;
+        const std::function<void(int)> *current = task;
+
+        lock.unlock();
+        std::exception_ptr failure;
+        try {
+            (*current)(index);
+        } catch (...) {
+            failure = std::current_exception();
+        }
+        lock.lock();
+
+        if (failure && !error) {
+            error = failure;
+        }
+        if (--pending == 0) {
+            done.notify_one();
+        }
+    }
+}
+
+/**
+ * ThreadPool::run(task)
+ *
+ * Runs task(index) once on every thread of the pool and waits for all of them to finish.
+ * The calling thread runs index 0. Calls from several threads at once are run one after the other.
+ *
+ * @example
+ *
+ *      // Print the index of each thread
+ *      pool.run([](int index) { std::cout << index << std::endl; });
+ *
+ * @param task
+ *      The task to run, called with the index of the thread running it.
+ *
+ * @throws
+ *      The first exception thrown by the task on any thread, once every thread has finished.
+ */
+void ThreadPool::run(const std::function<void(int)> &task) {
+    std::lock_guard<std::mutex> running(run_mutex);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->task = &task;
+        this->error = nullptr;
+        this->pending = static_cast<int>(workers.size());
+        this->round++;
+    }
+    start.notify_all();
+
+    std::exception_ptr failure;
+    try {
+        task(0);
+    } catch (...) {
+        failure = std::current_exception();
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&] { return pending == 0; });
+    this->task = nullptr;
+    if (!failure) {
+        failure = error;
+    }
+    lock.unlock();
+
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+}
+
+/**
+ * ThreadPool::parallel_for(count, body)
+ *
+ * Splits the range [0, count) into one contiguous band per thread and runs body(begin, end) for each
+ * non-empty band. Bands differ in size by at most one.
+ *
+ * @example
+ *
+ *      // Process the rows of a grid in parallel bands
+ *      pool.parallel_for(grid.get_height(), [&](int y0, int y1) { ... });
+ *
+ * @param count
+ *      The size of the range to split.
+ *
+ * @param body
+ *      The function to run on each band [begin, end).
+ */
+void ThreadPool::parallel_for(int count, const std::function<void(int, int)> &body) {
+    const long long threads = get_threads();
+    run([&](int index) {
+        int begin = static_cast<int>(count * index / threads);
+        int end = static_cast<int>(count * (index + 1) / threads);
+        if (begin < end) {
+            body(begin, end);
+        }
+    });
+}
+
+/**
+ * ThreadPool::take(index, task)
+ *
+ * Private helper function to take the task at the front of the queue of a thread.
+ *
+ * @param index
+ *      The index of the thread.
+ *
+ * @param task
+ *      Set to the task taken.
+ *
+ * @return
+ *      False if the queue was empty.
+ */
+bool ThreadPool::take(int index, std::uint64_t &task) {
+    std::atomic<std::uint64_t> &range = queues[index].range;
+    std::uint64_t current = range.load(std::memory_order_acquire);
+    for (;;) {
+        const std::uint64_t begin = current & 0xFFFFFFFF, end = current >> 32;
+        if (begin >= end) {
+            return false;
+        }
+        if (range.compare_exchange_weak(current, end << 32 | (begin + 1), std::memory_order_acq_rel)) {
+            task = begin;
+            return true;
+        }
+    }
+}
+
+/**
+ * ThreadPool::steal(index)
+ *
+ * Private helper function to refill the empty queue of a thread with the back half of the queue of another,
+ * trying each other thread in turn from the next index, those on the same node first.
+ *
+ * @param index
+ *      The index of the thread stealing.
+ *
+ * @return
+ *      False if every other queue was empty.
+ */
+bool ThreadPool::steal(int index) {
+    const int threads = static_cast<int>(queues.size());
+    // Steal from threads on the same node first, whose tasks are likely to touch memory on that node
+    for (int pass = 0; pass < 2; pass++) {
+        for (int offset = 1; offset < threads; offset++) {
+            Queue &victim = queues[(index + offset) % threads];
+            if ((victim.node == queues[index].node) != (pass == 0)) {
+                continue;
+            }
+            std::uint64_t current = victim.range.load(std::memory_order_acquire);
+            for (;;) {
+                const std::uint64_t begin = current & 0xFFFFFFFF, end = current >> 32;
+                if (begin >= end) {
+                    break;
+                }
+                const std::uint64_t middle = end - (end - begin + 1) / 2;
+                if (victim.range.compare_exchange_weak(current, middle << 32 | begin, std::memory_order_acq_rel)) {
+                    // No other thread takes from an empty queue, so the stolen tasks can be stored directly
+                    queues[index].range.store(end << 32 | middle, std::memory_order_release);
+                    queues[index].stats.steals++;
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * ThreadPool::steal_for(count, grain, body)
+ *
+ * Splits the range [0, count) into tasks of grain items, and runs body(begin, end) for each task with
+ * work stealing. Each thread starts on a contiguous share of the tasks, so neighbouring tasks mostly run
+ * on the same thread, and a thread that runs out steals half of the remaining tasks of another.
+ * Suits work where some parts of the range cost far more than others, which would leave threads idle
+ * with one fixed band each, see ThreadPool::parallel_for(count, body).
+ *
+ * @example
+ *
+ *      // Step the active tiles of a board, 4 at a time, however unevenly they are spread
+ *      pool.steal_for(active.size(), 4, [&](int begin, int end) { ... });
+ *
+ * @param count
+ *      The size of the range to split.
+ *
+ * @param grain
+ *      The number of items in each task. Values below 1 are treated as 1.
+ *
+ * @param body
+ *      The function to run on each task [begin, end).
+ *
+ * @throws
+ *      The first exception thrown by the body on any thread, once every thread has finished.
+ */
+void ThreadPool::steal_for(int count, int grain, const std::function<void(int, int)> &body) {
+    grain = std::max(grain, 1);
+    const std::uint64_t tasks = (std::max(count, 0) + std::uint64_t(grain) - 1) / grain;
+    const std::uint64_t threads = queues.size();
+    for (std::uint64_t i = 0; i < threads; i++) {
+        queues[i].range.store((tasks * (i + 1) / threads) << 32 | (tasks * i / threads), std::memory_order_relaxed);
+    }
+    queued += static_cast<long long>(tasks);
+
+    run([&](int index) {
+        ThreadStats &stats = queues[index].stats;
+        std::uint64_t task;
+        for (;;) {
+            if (!take(index, task)) {
+                if (!steal(index)) {
+                    return;
+                }
+                continue;
+            }
+            const auto started = std::chrono::steady_clock::now();
+            const int begin = static_cast<int>(task * grain);
+            const int end = static_cast<int>(std::min<std::uint64_t>(begin + std::uint64_t(grain), count));
+            body(begin, end);
+            stats.busy += std::chrono::steady_clock::now() - started;
+            stats.tasks++;
+            stats.items += end - begin;
+        }
+    });
+}
+
+/**
+ * ThreadPool::set_nodes(nodes)
+ *
+ * Sets the memory node each thread runs on, so that threads steal from others on the same node first,
+ * see ThreadPool::steal_for(count, grain, body). Pinning the threads to those nodes is up to the caller.
+ *
+ * @param nodes
+ *      The node of each thread by index. Threads missing from the list are put on node 0.
+ */
+void ThreadPool::set_nodes(const std::vector<int> &nodes) {
+    for (std::size_t i = 0; i < queues.size(); i++) {
+        queues[i].node = (i < nodes.size()) ? nodes[i] : 0;
+    }
+}
+
+/**
+ * ThreadPool::get_stats()
+ *
+ * Gets the work done by each thread over every call to ThreadPool::steal_for(count, grain, body)
+ * since the pool was made or the stats were reset. Only meaningful between calls.
+ *
+ * @example
+ *
+ *      // Report how evenly the work was spread
+ *      ThreadPool::Stats stats = pool.get_stats();
+ *      for (std::size_t i = 0; i < stats.threads.size(); i++) {
+ *          std::cout << i << ": " << stats.threads[i].tasks << " tasks, " << stats.threads[i].steals << " steals, "
+ *                    << stats.threads[i].busy.count() / 1e6 << " ms" << std::endl;
+ *      }
+ *
+ * @return
+ *      The number of tasks queued, and the tasks run, items of the range they covered, steals made,
+ *      and time spent running tasks by each thread.
+ */
+ThreadPool::Stats ThreadPool::get_stats() const {
+    Stats stats;
+    stats.queued = queued;
+    for (const Queue &queue : queues) {
+        stats.threads.push_back(queue.stats);
+    }
+    return stats;
+}
+
+/**
+ * ThreadPool::reset_stats()
+ *
+ * Sets the counts of ThreadPool::get_stats() back to zero.
+ */
+void ThreadPool::reset_stats() {
+    queued = 0;
+    for (Queue &queue : queues) {
+        queue.stats = ThreadStats{0, 0, 0, std::chrono::nanoseconds::zero()};
+    }
+}
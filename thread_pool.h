@@ -0,0 +1,93 @@
+/**
+ * Declares a class representing a persistent pool of worker threads.
+ * Rich documentation for the api and behaviour the ThreadPool class can be found in thread_pool.cpp.
+ *
+ * @author 959133
+ * @date March, 2020
+ */
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Declare the structure of the ThreadPool class for running the same task on several threads at once.
+ *
+ * The threads are started once on construction and reused for every call to ThreadPool::run,
+ * so running a task does not pay the cost of spawning threads.
+ *
+ * Work that is uneven across a range can be run with ThreadPool::steal_for, where threads that finish
+ * their share early take pieces of the share of another.
+ */
+class ThreadPool {
+public:
+    /**
+     * The work done by one thread of the pool, summed over every call to ThreadPool::steal_for.
+     */
+    struct ThreadStats {
+        long long tasks;
+        long long items;
+        long long steals;
+        std::chrono::nanoseconds busy;
+    };
+
+    /**
+     * The work done by the pool, summed over every call to ThreadPool::steal_for.
+     */
+    struct Stats {
+        long long queued;
+        std::vector<ThreadStats> threads;
+    };
+
+private:
+    // The tasks [begin, end) waiting in the queue of one thread, packed as end << 32 | begin so the owner
+    // can take from the front and thieves from the back with a single compare and swap.
+    // Padded so the queues of different threads do not share a cache line.
+    struct Queue {
+        std::atomic<std::uint64_t> range;
+        int node;
+        ThreadStats stats;
+        char padding[64];
+    };
+
+    std::vector<std::thread> workers;
+    std::vector<Queue> queues;
+    long long queued;
+
+    std::mutex run_mutex;
+    std::mutex mutex;
+    std::condition_variable start;
+    std::condition_variable done;
+
+    const std::function<void(int)> *task;
+    std::exception_ptr error;
+    unsigned long round;
+    int pending;
+    bool stopping;
+
+    void work(int index);
+    bool take(int index, std::uint64_t &task);
+    bool steal(int index);
+
+public:
+    explicit ThreadPool(int threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool& operator=(const ThreadPool &) = delete;
+
+    int get_threads() const;
+    void run(const std::function<void(int)> &task);
+    void parallel_for(int count, const std::function<void(int, int)> &body);
+    void steal_for(int count, int grain, const std::function<void(int, int)> &body);
+    void set_nodes(const std::vector<int> &nodes);
+
+    Stats get_stats() const;
+    void reset_stats();
+};
@@ -10,6 +10,7 @@
  *
  *      - Stepping a world forward in time applies the rules of Conway's Game of Life.
  *          - https://en.wikipedia.org/wiki/Conway%27s_Game_of_Life
+ *          - Any other life-like rule in B/S notation can be set instead, see rule.cpp.
  *
  *      - Worlds have a private helper function used to count the number of alive cells in a 3x3 neighbours
  *        around a given cell.
@@ -18,13 +19,61 @@
  *          - Moving off the left edge you appear on the right edge and vice versa.
  *          - Moving off the top edge you appear on the bottom edge and vice versa.
  *
+ *      - Worlds can step on several threads, sharing the work by work stealing, and optionally keep each
+ *        thread and the rows it steps on the same memory node of a multi-socket machine.
+ *
+ *      - Worlds can detect when they settle into a still life or oscillator by hashing each state,
+ *        and optionally skip the rest of a long run once they have.
+ *
+ *      - Worlds can step with one of several engines, all giving identical results.
+ *          - Engine::SCALAR updates one cell at a time.
+ *          - Engine::SCALAR and Engine::SIMD read a copy of the state padded with a ring of wrapped or dead
+ *            cells, so neither needs to handle the edges or the topology as special cases.
+ *          - Engine::PACKED packs the state into a BitGrid and updates 64 cells per word
+ *            using bitwise full-adder logic.
+ *          - Engine::SIMD updates the byte-per-cell state with SSE2, AVX2, or AVX-512 kernels
+ *            picked at runtime, see simd.cpp.
+ *          - Engine::PACKED can optionally track which 64x64 tiles changed and skip the stable ones.
+ *          - Engine::HASHLIFE and Engine::SPARSE are the exception. They simulate the unbounded plane,
+ *            with HashLife (see hashlife.cpp) or a sparse map of tiles (see sparse_world.cpp), and the world
+ *            shows the window of the plane covered by the grid. Cells that leave the window keep evolving
+ *            and may return, and toroidal worlds are not supported.
+ *
  * @author 959133
  * @date March, 2020
  */
 #include "world.h"
+#include "swar.h"
 
 // Include the minimal number of headers needed to support your implementation.
 // #include ...
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+/**
+ * The edge length of the square tiles used for tracking which areas of the world are active.
+ * Equal to the number of cells in a packed word, so each tile is one word wide.
+ */
+static const int TILE_SIZE = 64;
+
+/**
+ * The number of rows in each task when the rows of the world are shared between threads by work stealing.
+ * Small enough that a thread with a quiet band can take rows from a busy one, large enough that taking
+ * a task costs little next to stepping it.
+ */
+static const int BAND_ROWS = 16;
+
+/**
+ * The default size in bytes of each of the two buffers a strip of the packed state is stepped in with temporal
+ * blocking, see World::set_temporal_block_bytes(bytes). Together they take 512 KiB, so the generations of a strip
+ * only stay out of DRAM on CPUs with at least that much L2 cache per core.
+ */
+static const std::size_t DEFAULT_BLOCK_BYTES = 256 << 10;
 
 /**
  * World::World()
@@ -37,10 +86,7 @@
  *      World world;
  *
  */
-World::World() {
-    Grid g;
-    this->world = g;
-    this->nextWorld = g;
+World::World() : World(Grid()) {
 }
 
 /**
@@ -62,10 +108,7 @@ World::World() {
  * @param square_size
  *      The edge size to use for the width and height of the world.
  */
-World::World(int square_size) {
-    Grid g(square_size, square_size);
-    this->world = g;
-    this->nextWorld = g;
+World::World(int square_size) : World(Grid(square_size, square_size)) {
 }
 
 /**
@@ -83,16 +126,14 @@ World::World(int square_size) {
  * @param height
  *      The height of the world.
  */
-World::World(int width, int height) {
-    Grid g(width, height);
-    this->world = g;
-    this->nextWorld = g;
+World::World(int width, int height) : World(Grid(width, height)) {
 }
 
 /**
  * World::World(initial_state)
  *
  * Construct a world using the size and values of an existing grid.
+ * The other constructors delegate to this one, so it is the one place the settings of a new world are given.
  *
  * @example
  *
@@ -110,7 +151,121 @@ World::World(int width, int height) {
  */
 World::World(Grid initial_state) {
     this->world = initial_state;
-    this->nextWorld = initial_state;
+    this->engine = Engine::SCALAR;
+    this->world_stale = false;
+    this->packed_stale = true;
+    this->padded_stale = true;
+    this->hashlife_stale = true;
+    this->sparse_stale = true;
+    this->track_tiles = false;
+    this->tiles_toroidal = false;
+    this->temporal_block = 1;
+    this->temporal_block_bytes = DEFAULT_BLOCK_BYTES;
+    this->numa = false;
+    this->active_tiles = 0;
+    this->simd_kernel = Simd::get_kernel(Simd::detect());
+    this->generation = 0;
+    this->max_period = 0;
+    this->stop_on_cycle = false;
+    this->history_toroidal = false;
+    this->cycle_start = -1;
+    this->cycle_period = 0;
+}
+
+/**
+ * World::~World()
+ *
+ * Releases the calling thread from the CPU it was pinned to by NUMA mode, see World::set_numa(enabled).
+ */
+World::~World() {
+    numa = false;
+    apply_numa();
+}
+
+/**
+ * World::World(other)
+ *
+ * Construct a copy of another world, with the same state, rule, engine, and settings.
+ * The copy gets a thread pool of its own with as many threads, so the two can be stepped from different threads.
+ *
+ * @example
+ *
+ *      // Step a copy of a world on another thread
+ *      World world(Zoo::glider());
+ *      world.set_threads(4);
+ *      World copy(world);
+ *      std::thread other([&copy]() { copy.advance(100); });
+ *      world.advance(100);
+ *      other.join();
+ *
+ * @param other
+ *      The world to copy.
+ */
+World::World(const World &other) : World() {
+    copy_from(other);
+}
+
+/**
+ * World::operator=(other)
+ *
+ * Replaces this world with a copy of another, see World::World(other).
+ *
+ * @param other
+ *      The world to copy.
+ *
+ * @return
+ *      This world.
+ */
+World& World::operator=(const World &other) {
+    if (this != &other) {
+        copy_from(other);
+    }
+    return *this;
+}
+
+/**
+ * World::copy_from(other)
+ *
+ * Private helper function to copy every part of another world except its threads. The pool is made anew with
+ * the same number of threads, and pinned to the nodes if the other world is in NUMA mode.
+ *
+ * @param other
+ *      The world to copy.
+ */
+void World::copy_from(const World &other) {
+    world = other.get_state();
+    world_stale = false;
+    padded = other.padded;
+    nextPadded = other.nextPadded;
+    padded_stale = other.padded_stale;
+    engine = other.engine;
+    rule = other.rule;
+    packed = other.packed;
+    nextPacked = other.nextPacked;
+    packed_stale = other.packed_stale;
+    simd_kernel = other.simd_kernel;
+    hashlife = other.hashlife;
+    hashlife_stale = other.hashlife_stale;
+    sparse = other.sparse;
+    sparse_stale = other.sparse_stale;
+    track_tiles = other.track_tiles;
+    tiles_toroidal = other.tiles_toroidal;
+    temporal_block = other.temporal_block;
+    temporal_block_bytes = other.temporal_block_bytes;
+    tile_changed = other.tile_changed;
+    next_tile_changed = other.next_tile_changed;
+    active_list = other.active_list;
+    active_tiles = other.active_tiles;
+    generation = other.generation;
+    max_period = other.max_period;
+    stop_on_cycle = other.stop_on_cycle;
+    history_toroidal = other.history_toroidal;
+    history = other.history;
+    history_order = other.history_order;
+    cycle_start = other.cycle_start;
+    cycle_period = other.cycle_period;
+    numa = other.numa;
+    set_threads(other.get_threads());
 }
 
 /**
@@ -189,7 +344,7 @@ int World::get_height() const {
  * @return
  *      The number of total cells.
  */
-int World::get_total_cells() const{
+long long World::get_total_cells() const{
     return world.get_total_cells();
 };
 
@@ -216,8 +371,9 @@ int World::get_total_cells() const{
  * @return
  *      The number of alive cells.
  */
-int World::get_alive_cells() const{
-    int alive = 0;
+long long World::get_alive_cells() const{
+    sync_state();
+    long long alive = 0;
     for (auto it = std::begin(world.grid); it != std::end(world.grid); it++) {
         if (*it == Cell::ALIVE) {
             alive++;
@@ -250,8 +406,8 @@ int World::get_alive_cells() const{
  * @return
  *      The number of dead cells.
  */
-int World::get_dead_cells() const{
-    int dead = get_total_cells() - get_alive_cells();
+long long World::get_dead_cells() const{
+    long long dead = get_total_cells() - get_alive_cells();
     return dead;
 };
 
@@ -280,6 +436,7 @@ int World::get_dead_cells() const{
  *      A reference to the current state.
  */
 const Grid& World::get_state() const {
+    sync_state();
     return (Grid&) world;
 }
 
@@ -303,8 +460,13 @@ const Grid& World::get_state() const {
  *      The new edge size for both the width and height of the grid.
  */
 void World::resize(int square_size){
+    sync_state();
     world.resize(square_size);
-    nextWorld.grid.resize(square_size*square_size);
+    packed_stale = true;
+    padded_stale = true;
+    hashlife_stale = true;
+    sparse_stale = true;
+    reset_history();
 };
 
 /**
@@ -330,8 +492,13 @@ void World::resize(int square_size){
  *      The new height for the grid.
  */
  void World::resize(int new_width, int new_height) {
+    sync_state();
     world.resize(new_width, new_height);
-    nextWorld.grid.resize(new_width*new_height);
+    packed_stale = true;
+    padded_stale = true;
+    hashlife_stale = true;
+    sparse_stale = true;
+    reset_history();
  };
 
 /**
@@ -349,6 +516,9 @@ void World::resize(int square_size){
  *
  * If toroidal = true then correctly wrap out of bounds coordinates to the opposite side of the grid.
  *
+ * The coordinates of the cell are checked, then the three rows are found once with Grid::row(y) and read
+ * without per cell bounds checks, as the neighbouring coordinates have already been wrapped or dropped.
+ *
  * This function is in World and not Grid because the 3x3 sized neighbourhood is specific to Conway's Game of Life,
  * while Grid is more generic to any 2D grid based cellular automaton.
  *
@@ -364,28 +534,39 @@ void World::resize(int square_size){
  *
  * @return
  *      Returns the number of alive neighbours.
+ *
+ * @throws
+ *      std::out_of_range if the cell is outside the grid.
  */
 int World::count_neighbours(int x, int y, bool toroidal) {
-    int alive = 0;
+    sync_state();
+    const int width = world.get_width();
+    const int height = world.get_height();
+    if (x < 0 || x >= width || y < 0 || y >= height) {
+        throw std::out_of_range("Coordinates out of scope");
+    }
+
+    // Find the neighbouring rows and columns, wrapping them around on a torus or dropping them at the edges
+    const Cell *rows[3] = {nullptr, world.row(y), nullptr};
+    int columns[3] = {x - 1, x, x + 1};
     if (toroidal == true) {
-        for (int newY = y-1; newY <= y+1; newY++) {
-            for (int newX = x-1; newX <= x+1; newX++) {
-                if (!(newX == x && newY == y)){
-                    if (world.get((newX + get_width())% get_width(), (newY + get_height())%world.get_height()) == Cell::ALIVE) {
-                        alive++;
-                    }
-                    
-                }
-            }
-        }
+        rows[0] = world.row((y + height - 1) % height);
+        rows[2] = world.row((y + 1) % height);
+        columns[0] = (x + width - 1) % width;
+        columns[2] = (x + 1) % width;
     } else {
-        for (int newY = y-1; newY <= y+1; newY++) {
-            for (int newX = x-1; newX <= x+1; newX++) {
-                if (!(newX == x && newY == y) && (newX < get_width() && newX > -1) && (newY > -1 && newY < get_height())){
-                    if (world.get(newX,newY) == Cell::ALIVE) {
-                        alive++;
-                    }
-                }
+        rows[0] = (y > 0) ? world.row(y - 1) : nullptr;
+        rows[2] = (y + 1 < height) ? world.row(y + 1) : nullptr;
+    }
+
+    int alive = 0;
+    for (int i = 0; i < 3; i++) {
+        if (!rows[i]) {
+            continue;
+        }
+        for (int j = 0; j < 3; j++) {
+            if ((i != 1 || j != 1) && columns[j] >= 0 && columns[j] < width && rows[i][columns[j]] == Cell::ALIVE) {
+                alive++;
             }
         }
     }
@@ -398,69 +579,70 @@ int World::count_neighbours(int x, int y, bool toroidal) {
  * Take one step in Conway's Game of Life.
  *
  * Reads from the current state grid and writes to the next state grid. Then swaps the grids.
- * Should be implemented by invoking World::count_neighbours(x, y, toroidal).
+ * The scalar engine counts neighbours like World::count_neighbours(x, y, toroidal), but steps a copy of the state
+ * padded with a ring of wrapped or dead cells, see World::pad_state(). The copy is kept between steps and only its
+ * ring is refilled each step, see World::fill_ring(toroidal). The current state grid is updated from it when read.
  * Swapping the grids should be done in O(1) constant time, and should not invoke a copy.
  * Try and boil the logic down to the fewest and most simple conditional statements.
  *
+ * With Engine::PACKED the step is instead performed by World::step_packed(toroidal) on the bit-packed
+ * state, which is likewise only unpacked into the current state grid when read.
+ * With Engine::SIMD the step is instead performed by World::step_simd().
+ * The scalar, packed, and SIMD engines all step through World::step_dense(toroidal).
+ * With Engine::HASHLIFE the step is instead performed by World::advance_hashlife(1, toroidal).
+ * With Engine::SPARSE the step is instead performed by World::advance_sparse(1, toroidal).
+ *
+ * When more than one thread is set with World::set_threads(threads), the rows are split into
+ * horizontal bands that are stepped in parallel, shared between the threads by work stealing.
+ * Every band reads the whole current state grid, so the toroidal wrap across band edges needs no special handling.
+ *
  * Rules: https://en.wikipedia.org/wiki/Conway%27s_Game_of_Life
  *      - Any live cell with fewer than two live neighbours dies, as if by underpopulation.
  *      - Any live cell with two or three live neighbours lives on to the next generation.
  *      - Any live cell with more than three live neighbours dies, as if by overpopulation.
  *      - Any dead cell with exactly three live neighbours becomes a live cell, as if by reproduction.
+ * These are the default, B3/S23. Another rule can be set with World::set_rule(rule).
  *
  * @param toroidal
  *      Optional parameter. If true then the step will consider the grid as a torus, where the left edge
  *      wraps to the right edge and the top to the bottom. Defaults to false.
  */
 void World::step(bool toroidal) {
-    if (toroidal == true) {
-        for (int y = 0; y < world.get_height(); y++) {
-            for (int x = 0; x < world.get_width(); x++) {
-                int alive = count_neighbours(x,y, true);
-                if (world.get(x, y) == Cell::ALIVE) {
-                    if (alive < 2) {
-                        nextWorld.set(x,y, Cell::DEAD);
-                    } else if (alive == 2 || alive == 3) {
-                        nextWorld.set(x,y, Cell::ALIVE);
-                    } else if (alive > 3) {
-                        nextWorld.set(x,y, Cell::DEAD);
-                    }
-                } else if (world.get(x,y) == Cell::DEAD) {
-                    if (alive == 3) {
-                        nextWorld.set(x,y, Cell::ALIVE);
-                    }
-                }
-            }
-        }
+    if (engine == Engine::HASHLIFE) {
+        advance_hashlife(1, toroidal);
+        return;
+    }
+    if (engine == Engine::SPARSE) {
+        advance_sparse(1, toroidal);
+        return;
+    }
+
+    if (engine == Engine::PACKED) {
+        pack_state();
     } else {
-        for (int y = 0; y < world.get_height(); y++) {
-            for (int x = 0; x < world.get_width(); x++) {
-                int alive = count_neighbours(x,y,false);
-                if (world.get(x,y) == Cell::ALIVE) {
-                    if (alive < 2) {
-                        nextWorld.set(x,y, Cell::DEAD);
-                    } else if (alive == 2 || alive == 3) {
-                        nextWorld.set(x,y, Cell::ALIVE);
-                    } else if (alive > 3) {
-                        nextWorld.set(x,y, Cell::DEAD);
-                    }
-                } else {
-                     if (alive == 3) {
-                         nextWorld.set(x,y, Cell::ALIVE);
-                    }
-                }
-            }
-        }
+        pad_state();
     }
+    step_dense(toroidal);
+}
 
-    this->world = nextWorld;
-};
 /**
  * World::advance(steps, toroidal)
  *
  * Advance multiple steps in the Game of Life.
  * Should be implemented by invoking World::step(toroidal).
  *
+ * With Engine::PACKED the state is packed once and stepped the requested number of times with
+ * World::step_packed(toroidal), then only unpacked into the current state grid when read. When temporal blocking is set, see
+ * World::set_temporal_blocking(generations), the steps are instead taken several at a time by
+ * World::step_packed_blocked(generations, toroidal).
+ * With Engine::HASHLIFE all of the steps are taken at once by World::advance_hashlife(steps, toroidal),
+ * and with Engine::SPARSE by World::advance_sparse(steps, toroidal).
+ *
+ * When cycle detection is enabled with early stopping, see World::set_cycle_detection(max_period, stop_early),
+ * then once the world is found to repeat with period p every remaining whole period is skipped.
+ * Only the leftover steps modulo p are taken, so the final state and generation are exactly as if
+ * every step had been run.
+ *
  * @param steps
  *      The number of steps to advance the world forward.
  *
@@ -469,11 +651,1336 @@ void World::step(bool toroidal) {
  *      wraps to the right edge and the top to the bottom. Defaults to false.
  */
 void World::advance(int steps, bool toroidal) {
+    if (engine == Engine::HASHLIFE) {
+        advance_hashlife(steps, toroidal);
+        return;
+    }
+    if (engine == Engine::SPARSE) {
+        advance_sparse(steps, toroidal);
+        return;
+    }
+
+    if (engine == Engine::PACKED) {
+        pack_state();
+    } else {
+        pad_state();
+    }
+    if (engine == Engine::PACKED && temporal_block > 1 && !track_tiles && max_period == 0) {
+        // A pass takes at most a quarter of the rows that fit in a block as halo, so that a strip always fits
+        const std::size_t row_bytes = sizeof(std::uint64_t) * std::max(packed.get_words_per_row(), 1);
+        const int block_generations = static_cast<int>(std::min<std::size_t>(temporal_block, temporal_block_bytes / row_bytes / 4));
+        if (block_generations > 1) {
+            bind_numa();
+            for (int i = 0; i < steps; ) {
+                const int generations = std::min(block_generations, steps - i);
+                step_packed_blocked(generations, toroidal);
+                generation += generations;
+                i += generations;
+            }
+            world_stale = true;
+            steps = 0;
+        }
+    }
     for (int i = 0; i < steps; i++) {
-        if (toroidal == true) {
-            step(true);
-        } else if (toroidal == false) {
-            step(false);
+        step_dense(toroidal);
+        if (stop_on_cycle && cycle_period > 0) {
+            int remaining = steps - i - 1;
+            generation += remaining - remaining % cycle_period;
+            steps = i + 1 + remaining % cycle_period;
+        }
+    }
+}
+
+/**
+ * World::set_engine(engine)
+ *
+ * Selects the engine used by World::step and World::advance.
+ * The current state is preserved, every engine gives identical results.
+ *
+ * @example
+ *
+ *      // Make a world that steps 64 cells at a time
+ *      World world(Zoo::glider());
+ *      world.set_engine(Engine::PACKED);
+ *
+ * @param engine
+ *      The engine to use for future steps.
+ */
+void World::set_engine(Engine engine) {
+    sync_state();
+    this->engine = engine;
+    packed_stale = true;
+    padded_stale = true;
+    hashlife_stale = true;
+    sparse_stale = true;
+    reset_history();
+}
+
+/**
+ * World::get_engine()
+ *
+ * Gets the engine used by World::step and World::advance.
+ *
+ * @return
+ *      The current engine.
+ */
+Engine World::get_engine() const {
+    return this->engine;
+}
+
+/**
+ * World::set_rule(rule)
+ *
+ * Sets the life-like rule used by every engine, Conway's Game of Life (B3/S23) by default.
+ * The packed and sparse engines use kernels specialised at compile time for the common rules,
+ * see select_rule_kernel() in swar.h.
+ * Tiles skipped as stable under the old rule are all stepped again, see World::set_tile_tracking(enabled).
+ *
+ * @example
+ *
+ *      // Run a replicator under HighLife
+ *      World world(Zoo::load_ascii("replicator.gol"));
+ *      world.set_rule(Rule("B36/S23"));
+ *      world.advance(100);
+ *
+ * @param rule
+ *      The rule to use for future steps. Engine::HASHLIFE and Engine::SPARSE throw
+ *      when stepped under a rule with births on 0 neighbours.
+ */
+void World::set_rule(const Rule &rule) {
+    this->rule = rule;
+    tile_changed.clear();
+    reset_history();
+}
+
+/**
+ * World::get_rule()
+ *
+ * Gets the life-like rule used by every engine.
+ *
+ * @return
+ *      The current rule.
+ */
+const Rule& World::get_rule() const {
+    return this->rule;
+}
+
+/**
+ * World::set_threads(threads)
+ *
+ * Sets the number of threads used to step the world, run on a persistent ThreadPool reused by every step.
+ * Each step splits the rows, or with tile tracking the active tiles, into small tasks shared between
+ * the threads by work stealing, so threads whose part of the board is quiet help with the busy parts.
+ * The result matches a serial step exactly. With NUMA mode on the new threads are pinned to their nodes,
+ * see World::set_numa(enabled).
+ *
+ * @example
+ *
+ *      // Step a large world on 8 threads
+ *      World world(4096);
+ *      world.set_threads(8);
+ *      world.advance(100);
+ *
+ * @param threads
+ *      The number of threads. 1 or less steps on the calling thread only.
+ */
+void World::set_threads(int threads) {
+    if (threads > 1) {
+        pool.reset(new ThreadPool(threads));
+    } else {
+        pool.reset();
+    }
+    apply_numa();
+}
+
+/**
+ * World::get_threads()
+ *
+ * Gets the number of threads used to step the world.
+ *
+ * @return
+ *      The number of threads.
+ */
+int World::get_threads() const {
+    return pool ? pool->get_threads() : 1;
+}
+
+/**
+ * World::get_thread_stats()
+ *
+ * Gets how the work of stepping was shared between the threads since they were set or the stats were reset,
+ * see ThreadPool::get_stats().
+ *
+ * @example
+ *
+ *      // Check how much of a step each thread spent working
+ *      world.set_threads(4);
+ *      world.advance(100);
+ *      for (const ThreadPool::ThreadStats &thread : world.get_thread_stats().threads) {
+ *          std::cout << thread.tasks << " tasks, " << thread.steals << " steals" << std::endl;
+ *      }
+ *
+ * @return
+ *      The number of tasks queued, and the tasks run, steals made, and time spent running tasks by each thread.
+ *      Empty when stepping on the calling thread only.
+ */
+ThreadPool::Stats World::get_thread_stats() const {
+    return pool ? pool->get_stats() : ThreadPool::Stats{0, {}};
+}
+
+/**
+ * World::reset_thread_stats()
+ *
+ * Sets the counts of World::get_thread_stats() back to zero.
+ */
+void World::reset_thread_stats() {
+    if (pool) {
+        pool->reset_stats();
+    }
+}
+
+/**
+ * World::set_numa(enabled)
+ *
+ * Sets whether the threads and state of the world are kept together on the memory nodes of the machine.
+ *
+ * Without NUMA mode the buffers of the world are first touched by the thread that makes them, so on a machine
+ * with several sockets every thread on the other sockets reads and writes its band across the interconnect.
+ * With NUMA mode the threads are split into one contiguous block per node and each is pinned to a CPU of its node,
+ * the calling thread included, as it runs the first band of every step. Before a step, the rows each node starts
+ * with are bound to that node in every buffer the step touches, moving the pages already there, see
+ * World::bind_numa(). Threads steal work from their own node before any other.
+ *
+ * Only has an effect with more than one thread, see World::set_threads(threads), and on machines with more
+ * than one node. Turning it off, or destroying the world, releases the threads to run on any CPU again,
+ * and the calling thread to run on the CPUs it could before.
+ *
+ * @example
+ *
+ *      // Step a large world on every CPU of a two socket machine, and report the work done on each node
+ *      World world(32768);
+ *      world.set_engine(Engine::PACKED);
+ *      world.set_threads(std::thread::hardware_concurrency());
+ *      world.set_numa(true);
+ *      world.advance(100);
+ *      for (const Numa::NodeStats &node : world.get_node_stats()) {
+ *          std::cout << "Node " << node.node << ": " << node.items / (node.busy.count() / 1e9) << " rows/s" << std::endl;
+ *      }
+ *
+ * @param enabled
+ *      If true then pin the threads and bind the state to the nodes.
+ */
+void World::set_numa(bool enabled) {
+    numa = enabled;
+    apply_numa();
+}
+
+/**
+ * World::get_numa()
+ *
+ * Gets whether the threads and state of the world are kept together on the memory nodes of the machine.
+ *
+ * @return
+ *      True if NUMA mode is on.
+ */
+bool World::get_numa() const {
+    return numa;
+}
+
+/**
+ * World::get_node_stats()
+ *
+ * Gets the work done by the threads of each node since the threads were set or the stats were reset,
+ * summed from World::get_thread_stats(). Dividing the items by the busy time gives the throughput of a node,
+ * in rows per second for the row bands of the scalar, SIMD, and packed engines.
+ *
+ * @return
+ *      The threads, tasks run, items of work they covered, and time spent running tasks on each node in order.
+ *      Empty unless NUMA mode is on with more than one thread, on a machine with more than one node.
+ */
+std::vector<Numa::NodeStats> World::get_node_stats() const {
+    std::vector<Numa::NodeStats> nodes;
+    if (thread_nodes.empty()) {
+        return nodes;
+    }
+    const ThreadPool::Stats stats = pool->get_stats();
+    for (std::size_t i = 0; i < thread_nodes.size(); i++) {
+        if (nodes.empty() || nodes.back().node != thread_nodes[i]) {
+            nodes.push_back(Numa::NodeStats{thread_nodes[i], 0, 0, 0, std::chrono::nanoseconds::zero()});
+        }
+        Numa::NodeStats &node = nodes.back();
+        node.threads++;
+        node.tasks += stats.threads[i].tasks;
+        node.items += stats.threads[i].items;
+        node.busy += stats.threads[i].busy;
+    }
+    return nodes;
+}
+
+/**
+ * World::apply_numa()
+ *
+ * Private helper function to pin the threads of the pool to their nodes when NUMA mode is on,
+ * or to release them when it is off. Thread i of n is put on node i * nodes / n, and on the CPUs of that
+ * node in turn, so the contiguous share of rows each thread starts a step with lies in one block per node.
+ *
+ * The calling thread runs thread 0, so it is pinned too. The CPUs it could run on before are saved and
+ * restored once NUMA mode ends, as long as that happens on the same thread. Nothing is pinned on a machine
+ * with a single node, where there is no memory to keep close.
+ */
+void World::apply_numa() {
+    numa_bound.clear();
+    if (!thread_nodes.empty()) {
+        if (pool) {
+            pool->run([](int) { Numa::pin_thread(-1); });
+            pool->set_nodes({});
+        }
+        if (caller == std::this_thread::get_id()) {
+            Numa::set_affinity(caller_affinity);
+        }
+        caller_affinity.clear();
+        thread_nodes.clear();
+    }
+
+    const std::vector<Numa::Node> &nodes = Numa::topology();
+    if (!numa || !pool || nodes.size() <= 1) {
+        return;
+    }
+
+    const std::size_t threads = static_cast<std::size_t>(pool->get_threads());
+    std::vector<int> cpus(threads);
+    thread_nodes.assign(threads, 0);
+    for (std::size_t i = 0; i < threads; i++) {
+        const std::size_t node = i * nodes.size() / threads;
+        const std::size_t first = (node * threads + nodes.size() - 1) / nodes.size();
+        thread_nodes[i] = nodes[node].id;
+        cpus[i] = nodes[node].cpus[(i - first) % nodes[node].cpus.size()];
+    }
+    caller_affinity = Numa::get_affinity();
+    caller = std::this_thread::get_id();
+    pool->run([&](int index) { Numa::pin_thread(cpus[index]); });
+    pool->set_nodes(thread_nodes);
+}
+
+/**
+ * World::bind_numa()
+ *
+ * Private helper function to bind the rows each node starts a step with to that node, in the current and next
+ * state grid, the padded buffers, and the packed buffers. The rows follow the shares of World::for_each_band(body).
+ * Buffers are only bound again once one of them has been reallocated, so most steps skip straight past.
+ */
+void World::bind_numa() {
+    if (thread_nodes.empty() || thread_nodes.front() == thread_nodes.back()) {
+        return;
+    }
+    const int width = world.get_width();
+    const int height = world.get_height();
+    const bool has_packed = packed.get_height() == height && nextPacked.get_height() == height && height > 0;
+    const bool has_padded = padded.get_height() == height + 2 && nextPadded.get_height() == height + 2;
+    std::vector<const void*> buffers = {
+        world.grid.data(), has_padded ? padded.grid.data() : nullptr, has_padded ? nextPadded.grid.data() : nullptr,
+        has_packed ? packed.row(0) : nullptr, has_packed ? nextPacked.row(0) : nullptr
+    };
+    std::sort(buffers.begin(), buffers.end());
+    if (buffers == numa_bound) {
+        return;
+    }
+    numa_bound = buffers;
+
+    // Thread i starts on the bands from task tasks * i / threads, see ThreadPool::steal_for(count, grain, body)
+    const long long threads = static_cast<long long>(thread_nodes.size());
+    const long long tasks = (height + BAND_ROWS - 1) / BAND_ROWS;
+    auto first_row = [&](long long thread) {
+        return std::min<long long>(height, tasks * thread / threads * BAND_ROWS);
+    };
+    auto bind_rows = [&](const void *data, std::size_t row_bytes, long long offset) {
+        for (long long i = 0; i < threads; ) {
+            long long j = i + 1;
+            while (j < threads && thread_nodes[j] == thread_nodes[i]) {
+                j++;
+            }
+            const long long y0 = first_row(i), y1 = first_row(j);
+            Numa::bind(static_cast<const char*>(data) + (y0 + offset) * row_bytes, (y1 - y0) * row_bytes,
+                       thread_nodes[i]);
+            i = j;
+        }
+    };
+
+    bind_rows(world.grid.data(), width, 0);
+    if (has_padded) {
+        bind_rows(padded.grid.data(), width + 2, 1);
+        bind_rows(nextPadded.grid.data(), width + 2, 1);
+    }
+    if (has_packed) {
+        const std::size_t row_bytes = sizeof(std::uint64_t) * packed.get_words_per_row();
+        bind_rows(packed.row(0), row_bytes, 0);
+        bind_rows(nextPacked.row(0), row_bytes, 0);
+    }
+}
+
+/**
+ * World::for_each_band(body)
+ *
+ * Private helper function to run body(y0, y1) over the rows [0, height) of the world,
+ * either as one band on the calling thread or as bands of BAND_ROWS rows shared by work stealing.
+ *
+ * @param body
+ *      The function to run on each band of rows [y0, y1).
+ */
+void World::for_each_band(const std::function<void(int, int)> &body) const {
+    for_each_task(world.get_height(), BAND_ROWS, body);
+}
+
+/**
+ * World::for_each_range(count, body)
+ *
+ * Private helper function to run body(begin, end) over the range [0, count),
+ * either as one band on the calling thread or as one band per thread of the pool.
+ * For work that costs the same across the range.
+ *
+ * @param count
+ *      The size of the range.
+ *
+ * @param body
+ *      The function to run on each band [begin, end).
+ */
+void World::for_each_range(int count, const std::function<void(int, int)> &body) const {
+    if (pool) {
+        pool->parallel_for(count, body);
+    } else if (count > 0) {
+        body(0, count);
+    }
+}
+
+/**
+ * World::for_each_task(count, grain, body)
+ *
+ * Private helper function to run body(begin, end) over the range [0, count),
+ * either as one band on the calling thread or as tasks of grain items shared by work stealing.
+ * For work that may cost far more in some parts of the range than others.
+ *
+ * @param count
+ *      The size of the range.
+ *
+ * @param grain
+ *      The number of items in each task.
+ *
+ * @param body
+ *      The function to run on each task [begin, end).
+ */
+void World::for_each_task(int count, int grain, const std::function<void(int, int)> &body) const {
+    if (pool) {
+        pool->steal_for(count, grain, body);
+    } else if (count > 0) {
+        body(0, count);
+    }
+}
+
+/**
+ * World::pad_state()
+ *
+ * Private helper function to copy the current state grid into the middle of the padded buffers, which are two cells
+ * wider and taller, unless they already hold the current state. The scalar and SIMD engines then step the padded
+ * state in place of the current state grid, which is only copied back when read, see World::sync_state().
+ */
+void World::pad_state() {
+    if (!padded_stale) {
+        return;
+    }
+    const int width = world.get_width();
+    const int height = world.get_height();
+    padded = Grid(width + 2, height + 2);
+    nextPadded = Grid(width + 2, height + 2);
+    for_each_band([&](int y0, int y1) {
+        for (int y = y0; y < y1; y++) {
+            std::copy(world.row(y), world.row(y) + width, padded.row(y + 1) + 1);
         }
+    });
+    padded_stale = false;
+}
+
+/**
+ * World::sync_state()
+ *
+ * Private helper function to copy the middle of the padded state, or with Engine::PACKED the bit-packed state,
+ * back into the current state grid, if it has been stepped since the grid was last brought up to date.
+ * The stepped state stays valid, so a following step can continue without padding or packing again.
+ *
+ * The const getters call this, so it may be called from several threads at once. The copy is made by
+ * whichever takes the mutex first, and the others wait for it, then find the grid already up to date.
+ */
+void World::sync_state() const {
+    if (!world_stale.load(std::memory_order_acquire)) {
+        return;
     }
+    std::lock_guard<std::mutex> lock(sync_mutex);
+    if (!world_stale.load(std::memory_order_relaxed)) {
+        return;
+    }
+    if (engine == Engine::PACKED) {
+        unpack_state();
+    } else {
+        const int width = world.get_width();
+        for_each_band([&](int y0, int y1) {
+            for (int y = y0; y < y1; y++) {
+                const Cell *cells = padded.row(y + 1) + 1;
+                std::copy(cells, cells + width, world.row(y));
+            }
+        });
+    }
+    world_stale.store(false, std::memory_order_release);
+}
+
+/**
+ * World::fill_ring(toroidal)
+ *
+ * Private helper function to fill the ring of cells around the edge of the padded state with the cells it wraps to
+ * when toroidal, otherwise with dead cells, so the scalar and SIMD engines can read every neighbour without checking
+ * the edges. Only the ring is written, so a step pays for the edges of the grid rather than for a copy of all of it.
+ *
+ * @param toroidal
+ *      If true then the ring wraps the left edge to the right edge and the top to the bottom.
+ */
+void World::fill_ring(bool toroidal) {
+    const int width = world.get_width();
+    const int height = world.get_height();
+    if (width == 0 || height == 0) {
+        return;
+    }
+
+    for (int y = 1; y <= height; y++) {
+        Cell *cells = padded.row(y);
+        cells[0] = toroidal ? cells[width] : Cell::DEAD;
+        cells[width + 1] = toroidal ? cells[1] : Cell::DEAD;
+    }
+
+    // The rows above and below, which already hold the wrapped corners
+    Cell *top = padded.row(0);
+    Cell *bottom = padded.row(height + 1);
+    if (toroidal) {
+        std::copy(padded.row(height), padded.row(height) + width + 2, top);
+        std::copy(padded.row(1), padded.row(1) + width + 2, bottom);
+    } else {
+        std::fill(top, top + width + 2, Cell::DEAD);
+        std::fill(bottom, bottom + width + 2, Cell::DEAD);
+    }
+}
+
+/**
+ * World::step_scalar(y0, y1)
+ *
+ * Private helper function to compute the rows [y0, y1) of the next padded state one cell at a time,
+ * reading the neighbours from the padded state, whose ring is filled by World::fill_ring(toroidal).
+ * Every cell of the rows is written, as the next padded state still holds the state from two steps ago.
+ *
+ * Live cells have an odd value and dead cells an even one, so the neighbours are counted by summing their
+ * lowest bits, and the next state is looked up in a table built from the rule. The loop has no branches.
+ *
+ * @param y0
+ *      The first row to compute.
+ *
+ * @param y1
+ *      One past the last row to compute.
+ */
+void World::step_scalar(int y0, int y1) {
+    static_assert((Cell::ALIVE & 1) == 1 && (Cell::DEAD & 1) == 0, "Cells are counted by their lowest bit");
+    Cell next_state[2][9];
+    for (int alive = 0; alive <= 8; alive++) {
+        next_state[0][alive] = rule.next(Cell::DEAD, alive);
+        next_state[1][alive] = rule.next(Cell::ALIVE, alive);
+    }
+
+    const int width = world.get_width();
+    for (int y = y0; y < y1; y++) {
+        const Cell *up = padded.row(y) + 1;
+        const Cell *mid = padded.row(y + 1) + 1;
+        const Cell *down = padded.row(y + 2) + 1;
+        Cell *next = nextPadded.row(y + 1) + 1;
+        for (int x = 0; x < width; x++) {
+            const int alive = (up[x - 1] & 1) + (up[x] & 1) + (up[x + 1] & 1)
+                            + (mid[x - 1] & 1) + (mid[x + 1] & 1)
+                            + (down[x - 1] & 1) + (down[x] & 1) + (down[x + 1] & 1);
+            next[x] = next_state[mid[x] & 1][alive];
+        }
+    }
+}
+
+/**
+ * World::set_tile_tracking(enabled)
+ *
+ * Enables tracking which 64x64 tiles of the world changed, so Engine::PACKED can skip the tiles where
+ * neither the tile nor any of its neighbours changed in the previous step. Boards mostly made of still
+ * lifes and oscillators in empty space then only pay for the few tiles that are still active.
+ *
+ * @example
+ *
+ *      // Step a soup, skipping settled areas, and report how many tiles were stepped
+ *      world.set_engine(Engine::PACKED);
+ *      world.set_tile_tracking(true);
+ *      world.step();
+ *      std::cout << world.get_active_tiles() << " of " << world.get_total_tiles() << std::endl;
+ *
+ * @param enabled
+ *      If true then skip stable tiles.
+ */
+void World::set_tile_tracking(bool enabled) {
+    track_tiles = enabled;
+    tile_changed.clear();
+}
+
+/**
+ * World::get_active_tiles()
+ *
+ * Gets the number of 64x64 tiles computed by the last step of Engine::PACKED.
+ * Without tile tracking every tile is computed.
+ *
+ * @return
+ *      The number of active tiles in the last step.
+ */
+int World::get_active_tiles() const {
+    return active_tiles;
+}
+
+/**
+ * World::get_total_tiles()
+ *
+ * Gets the number of 64x64 tiles covering the world. Partial tiles on the right and bottom edges count as tiles.
+ *
+ * @return
+ *      The total number of tiles.
+ */
+int World::get_total_tiles() const {
+    return ((get_width() + TILE_SIZE - 1) / TILE_SIZE) * ((get_height() + TILE_SIZE - 1) / TILE_SIZE);
+}
+
+/**
+ * World::set_temporal_blocking(generations)
+ *
+ * Sets how many generations Engine::PACKED advances each strip of the world by per pass over memory.
+ *
+ * A step normally streams the whole state from memory and back, which bounds the speed of boards much larger
+ * than the cache by the memory bandwidth. With temporal blocking World::advance(steps, toroidal) instead copies
+ * a cache sized strip of rows into a local buffer along with that many rows above and below, and steps it that
+ * many generations in cache before writing it back, cutting the memory traffic by about the same factor.
+ * Each generation leaves one more row at each edge of the buffer out of date, so the extra rows are stepped
+ * as well, at a cost that grows with the number of generations.
+ *
+ * The strip and its halo are kept within the size set by World::set_temporal_block_bytes(bytes), so a pass takes
+ * at most a quarter of the rows that fit in it as generations. Very wide boards therefore take fewer generations per pass than asked, down to one,
+ * where temporal blocking is skipped.
+ *
+ * Tile tracking and cycle detection need every generation of the whole board, so either disables it.
+ *
+ * @example
+ *
+ *      // Advance a 65536x65536 board 8 generations per pass over memory, which needs about 9 GiB
+ *      World world(65536);
+ *      world.set_engine(Engine::PACKED);
+ *      world.set_temporal_blocking(8);
+ *      world.advance(1000);
+ *
+ * @param generations
+ *      The number of generations per pass. 1 or less steps one generation at a time.
+ */
+void World::set_temporal_blocking(int generations) {
+    temporal_block = std::max(generations, 1);
+}
+
+/**
+ * World::get_temporal_blocking()
+ *
+ * Gets how many generations Engine::PACKED advances each strip of the world by per pass over memory.
+ *
+ * @return
+ *      The number of generations per pass, 1 when temporal blocking is off.
+ */
+int World::get_temporal_blocking() const {
+    return temporal_block;
+}
+
+/**
+ * World::set_temporal_block_bytes(bytes)
+ *
+ * Sets the size in bytes of each of the two buffers a strip and its halo are stepped in with temporal blocking,
+ * see World::set_temporal_blocking(generations). Both buffers are in use at once, so the pair should fit in
+ * the L2 cache of one core. The default of 256 KiB suits cores with 512 KiB of L2 or more, and should be lowered
+ * on CPUs with less, or raised on those with more.
+ *
+ * @example
+ *
+ *      // Keep the strips within a 256 KiB L2 cache
+ *      world.set_temporal_block_bytes(128 << 10);
+ *
+ * @param bytes
+ *      The size of each buffer. Sizes too small for a strip of more than one generation turn temporal blocking off.
+ */
+void World::set_temporal_block_bytes(std::size_t bytes) {
+    temporal_block_bytes = bytes;
+}
+
+/**
+ * World::get_temporal_block_bytes()
+ *
+ * Gets the size in bytes of each of the two buffers a strip is stepped in with temporal blocking.
+ *
+ * @return
+ *      The size of each buffer, 256 KiB unless set.
+ */
+std::size_t World::get_temporal_block_bytes() const {
+    return temporal_block_bytes;
+}
+
+/**
+ * World::set_hashlife_memory(bytes)
+ *
+ * Sets the size the HashLife node cache used by Engine::HASHLIFE may reach before it is garbage collected.
+ *
+ * @param bytes
+ *      The limit in bytes.
+ */
+void World::set_hashlife_memory(std::size_t bytes) {
+    hashlife.set_memory_limit(bytes);
+}
+
+/**
+ * World::set_simd_level(level)
+ *
+ * Overrides the instruction set level used by Engine::SIMD, which defaults to the fastest level
+ * reported by Simd::detect(). Useful for comparing kernels against each other on one machine.
+ *
+ * @example
+ *
+ *      // Compare against the SSE2 kernel, which every x86-64 CPU supports
+ *      World world(4096);
+ *      world.set_engine(Engine::SIMD);
+ *      world.set_simd_level(Simd::Level::SSE2);
+ *
+ * @param level
+ *      The instruction set level to use.
+ *
+ * @throws
+ *      std::invalid_argument if the level is above Simd::detect(), as the CPU or the build does not support it.
+ */
+void World::set_simd_level(Simd::Level level) {
+    if (level > Simd::detect()) {
+        throw std::invalid_argument(std::string("The SIMD level ") + Simd::name(level) + " is not supported by this CPU");
+    }
+    this->simd_kernel = Simd::get_kernel(level);
+}
+
+/**
+ * World::pack_state()
+ *
+ * Private helper function to copy the current state grid into the bit-packed buffers,
+ * unless they already hold the current state.
+ */
+void World::pack_state() {
+    if (packed_stale) {
+        packed = BitGrid(world);
+        nextPacked = BitGrid(world.get_width(), world.get_height());
+        tile_changed.clear();
+        packed_stale = false;
+    }
+}
+
+/**
+ * World::unpack_state()
+ *
+ * Private helper function to copy the bit-packed current state back into the current state grid.
+ * The rows are unpacked in place, so the grid keeps its memory, and any pages bound to a node stay there.
+ * The packed buffers stay valid, so a following step can continue without packing again.
+ */
+void World::unpack_state() const {
+    for_each_band([&](int y0, int y1) { packed.to_grid(world, y0, y1); });
+}
+
+/**
+ * PackedRow<Birth, Survival>::run(up, mid, down, out, i0, i1, words, width, toroidal, birth, survival)
+ *
+ * Computes the next state of the words [i0, i1) of one bit-packed row from the rows above and below it,
+ * specialised for a rule, see select_rule_kernel() in swar.h.
+ * The east and west neighbours of a word are formed by shifting the row by one bit,
+ * carrying in the edge bit of the adjacent word, or the wrapped edge cell when toroidal.
+ */
+template <unsigned Birth, unsigned Survival>
+struct PackedRow {
+    static void run(const std::uint64_t *up, const std::uint64_t *mid, const std::uint64_t *down,
+                    std::uint64_t *out, int i0, int i1, int words, int width, bool toroidal,
+                    unsigned birth, unsigned survival) {
+        const int last = words - 1;
+        const int tail_bit = (width - 1) % 64;
+        const std::uint64_t tail_mask = (tail_bit == 63) ? ~std::uint64_t(0) : (std::uint64_t(2) << tail_bit) - 1;
+
+        auto west = [&](const std::uint64_t *row, int i) {
+            std::uint64_t carry = (i > 0) ? row[i - 1] >> 63 : (toroidal ? (row[last] >> tail_bit) & 1 : 0);
+            return (row[i] << 1) | carry;
+        };
+        auto east = [&](const std::uint64_t *row, int i) {
+            std::uint64_t shifted = row[i] >> 1;
+            if (i < last) {
+                return shifted | (row[i + 1] << 63);
+            }
+            return shifted | ((toroidal ? row[0] & 1 : 0) << tail_bit);
+        };
+
+        for (int i = i0; i < i1; i++) {
+            std::uint64_t next = next_generation<Birth, Survival>(west(up, i),   up[i],   east(up, i),
+                                                                  west(mid, i),  mid[i],  east(mid, i),
+                                                                  west(down, i), down[i], east(down, i),
+                                                                  birth, survival);
+            out[i] = (i == last) ? next & tail_mask : next;
+        }
+    }
+};
+
+/**
+ * World::step_packed(toroidal)
+ *
+ * Private helper function to take one step on the bit-packed state.
+ * Reads from the packed current state and writes to the packed next state. Then swaps them.
+ *
+ * If toroidal = false the rows above the top and below the bottom of the grid are read as dead,
+ * otherwise they wrap to the opposite edge.
+ *
+ * @param toroidal
+ *      If true then the step will consider the grid as a torus, where the left edge
+ *      wraps to the right edge and the top to the bottom.
+ */
+void World::step_packed(bool toroidal) {
+    const int width = packed.get_width();
+    const int height = packed.get_height();
+    const int words = packed.get_words_per_row();
+    if (words == 0 || height == 0) {
+        return;
+    }
+
+    const unsigned birth = rule.get_birth(), survival = rule.get_survival();
+    const auto step_packed_row = select_rule_kernel<PackedRow>(birth, survival);
+    const std::vector<std::uint64_t> dead(words, 0);
+    for_each_band([&](int y0, int y1) {
+        for (int y = y0; y < y1; y++) {
+            const std::uint64_t *up, *down;
+            if (toroidal) {
+                up = packed.row((y + height - 1) % height);
+                down = packed.row((y + 1) % height);
+            } else {
+                up = (y > 0) ? packed.row(y - 1) : dead.data();
+                down = (y < height - 1) ? packed.row(y + 1) : dead.data();
+            }
+            step_packed_row(up, packed.row(y), down, nextPacked.row(y), 0, words, words, width, toroidal,
+                            birth, survival);
+        }
+    });
+
+    active_tiles = ((height + TILE_SIZE - 1) / TILE_SIZE) * words;
+    std::swap(packed, nextPacked);
+}
+
+/**
+ * World::step_packed_blocked(generations, toroidal)
+ *
+ * Private helper function to take several steps on the bit-packed state with a single pass over memory,
+ * see World::set_temporal_blocking(generations).
+ * Reads from the packed current state and writes to the packed next state. Then swaps them.
+ *
+ * The rows are split into strips sized so that a strip and its halo fit in World::get_temporal_block_bytes(), which
+ * World::advance(steps, toroidal) ensures by taking at most a quarter of those rows as generations. Each strip is copied
+ * into a local buffer with the given number of rows either side, wrapped when toroidal and dead otherwise,
+ * then stepped between two local buffers. After each generation one row less at each edge of the buffer is
+ * correct, so after the last the halo is used up and exactly the rows of the strip are written back.
+ * When not toroidal the rows beyond the edges of the grid are kept dead rather than stepped.
+ *
+ * @param generations
+ *      The number of steps to take.
+ *
+ * @param toroidal
+ *      If true then the step will consider the grid as a torus, where the left edge
+ *      wraps to the right edge and the top to the bottom.
+ */
+void World::step_packed_blocked(int generations, bool toroidal) {
+    const int width = packed.get_width();
+    const int height = packed.get_height();
+    const int words = packed.get_words_per_row();
+    if (words == 0 || height == 0) {
+        return;
+    }
+
+    const unsigned birth = rule.get_birth(), survival = rule.get_survival();
+    const auto step_packed_row = select_rule_kernel<PackedRow>(birth, survival);
+    const int halo_rows = generations;
+    const int block_rows = static_cast<int>(temporal_block_bytes / (sizeof(std::uint64_t) * words));
+    const int strip_rows = std::max(1, block_rows - 2 * halo_rows);
+    const int strips = (height + strip_rows - 1) / strip_rows;
+
+    for_each_task(strips, 1, [&](int s0, int s1) {
+        static thread_local std::vector<std::uint64_t> current, next;
+        for (int s = s0; s < s1; s++) {
+            const int y0 = s * strip_rows;
+            const int rows = std::min(strip_rows, height - y0) + 2 * halo_rows;
+            current.resize(static_cast<std::size_t>(rows) * words);
+            next.resize(static_cast<std::size_t>(rows) * words);
+
+            // Local row i holds the grid row y0 - halo_rows + i
+            auto inside = [&](int i) {
+                const int y = y0 - halo_rows + i;
+                return toroidal || (y >= 0 && y < height);
+            };
+            for (int i = 0; i < rows; i++) {
+                std::uint64_t *local = current.data() + static_cast<std::size_t>(i) * words;
+                if (inside(i)) {
+                    const std::uint64_t *row = packed.row(((y0 - halo_rows + i) % height + height) % height);
+                    std::copy(row, row + words, local);
+                } else {
+                    std::fill(local, local + words, 0);
+                }
+            }
+
+            for (int g = 1; g <= generations; g++) {
+                for (int i = g; i < rows - g; i++) {
+                    std::uint64_t *out = next.data() + static_cast<std::size_t>(i) * words;
+                    if (!inside(i)) {
+                        std::fill(out, out + words, 0);
+                        continue;
+                    }
+                    const std::uint64_t *mid = current.data() + static_cast<std::size_t>(i) * words;
+                    step_packed_row(mid - words, mid, mid + words, out, 0, words, words, width, toroidal,
+                                    birth, survival);
+                }
+                std::swap(current, next);
+            }
+
+            for (int i = halo_rows; i < rows - halo_rows; i++) {
+                const std::uint64_t *local = current.data() + static_cast<std::size_t>(i) * words;
+                std::copy(local, local + words, nextPacked.row(y0 - halo_rows + i));
+            }
+        }
+    });
+
+    active_tiles = ((height + TILE_SIZE - 1) / TILE_SIZE) * words;
+    std::swap(packed, nextPacked);
+}
+
+/**
+ * World::step_packed_tiles(toroidal)
+ *
+ * Private helper function to take one step on the bit-packed state, skipping stable areas.
+ *
+ * The grid is split into tiles of 64x64 cells, each one word wide. A tile can only change if it,
+ * or one of its eight neighbouring tiles, changed during the previous step. Only those active tiles are
+ * computed. A skipped tile holds the same cells in both packed buffers, so it needs no copying either.
+ * Every tile is active again after a step under the other topology, as the flags were computed for the old one.
+ *
+ * @param toroidal
+ *      If true then the step will consider the grid as a torus, where the left edge
+ *      wraps to the right edge and the top to the bottom. Neighbouring tiles wrap in the same way.
+ */
+void World::step_packed_tiles(bool toroidal) {
+    const int width = packed.get_width();
+    const int height = packed.get_height();
+    const int words = packed.get_words_per_row();
+    if (words == 0 || height == 0) {
+        active_tiles = 0;
+        return;
+    }
+
+    const int tiles_x = words;
+    const int tiles_y = (height + TILE_SIZE - 1) / TILE_SIZE;
+    // Flags from a step under the other topology say nothing about the tiles along the edges
+    if (tile_changed.size() != static_cast<std::size_t>(tiles_x) * tiles_y || toroidal != tiles_toroidal) {
+        tile_changed.assign(static_cast<std::size_t>(tiles_x) * tiles_y, 1);
+        tiles_toroidal = toroidal;
+    }
+    next_tile_changed.assign(tile_changed.size(), 0);
+
+    active_list.clear();
+    for (int ty = 0; ty < tiles_y; ty++) {
+        for (int tx = 0; tx < tiles_x; tx++) {
+            bool active = false;
+            for (int dy = -1; dy <= 1 && !active; dy++) {
+                for (int dx = -1; dx <= 1 && !active; dx++) {
+                    int ny = ty + dy, nx = tx + dx;
+                    if (toroidal) {
+                        ny = (ny + tiles_y) % tiles_y;
+                        nx = (nx + tiles_x) % tiles_x;
+                    } else if (ny < 0 || ny >= tiles_y || nx < 0 || nx >= tiles_x) {
+                        continue;
+                    }
+                    active = tile_changed[ny * tiles_x + nx] != 0;
+                }
+            }
+            if (active) {
+                active_list.push_back(ty * tiles_x + tx);
+            }
+        }
+    }
+
+    const unsigned birth = rule.get_birth(), survival = rule.get_survival();
+    const auto step_packed_row = select_rule_kernel<PackedRow>(birth, survival);
+    const std::vector<std::uint64_t> dead(words, 0);
+    for_each_task(static_cast<int>(active_list.size()), 1, [&](int begin, int end) {
+        for (int k = begin; k < end; k++) {
+            const int tile = active_list[k];
+            const int tx = tile % tiles_x;
+            const int y0 = (tile / tiles_x) * TILE_SIZE;
+            const int y1 = std::min(y0 + TILE_SIZE, height);
+            bool changed = false;
+            for (int y = y0; y < y1; y++) {
+                const std::uint64_t *up, *down;
+                if (toroidal) {
+                    up = packed.row((y + height - 1) % height);
+                    down = packed.row((y + 1) % height);
+                } else {
+                    up = (y > 0) ? packed.row(y - 1) : dead.data();
+                    down = (y < height - 1) ? packed.row(y + 1) : dead.data();
+                }
+                std::uint64_t *out = nextPacked.row(y);
+                step_packed_row(up, packed.row(y), down, out, tx, tx + 1, words, width, toroidal, birth, survival);
+                changed = changed || out[tx] != packed.row(y)[tx];
+            }
+            next_tile_changed[tile] = changed;
+        }
+    });
+
+    active_tiles = static_cast<int>(active_list.size());
+    std::swap(tile_changed, next_tile_changed);
+    std::swap(packed, nextPacked);
+}
+
+/**
+ * World::step_simd()
+ *
+ * Private helper function to take one step using a vectorized row kernel.
+ * Reads from the padded state, whose ring is filled by World::fill_ring(toroidal), and writes to the middle
+ * of the next padded state. Then swaps them.
+ *
+ * The ring of the padded state gives every cell all three neighbouring columns and rows, so the kernel
+ * covers whole rows with no special cases at the edges.
+ */
+void World::step_simd() {
+    const int width = world.get_width();
+    for_each_band([&](int y0, int y1) {
+        for (int y = y0; y < y1; y++) {
+            const Cell *up = padded.row(y) + 1;
+            const Cell *mid = padded.row(y + 1) + 1;
+            const Cell *down = padded.row(y + 2) + 1;
+            simd_kernel(up, mid, down, nextPadded.row(y + 1) + 1, 0, width, rule.get_birth(), rule.get_survival());
+        }
+    });
+
+    std::swap(padded, nextPadded);
+}
+
+/**
+ * World::advance_hashlife(steps, toroidal)
+ *
+ * Private helper function to advance the world using HashLife.
+ * The current state grid is imported into the HashLife universe when it has changed outside of HashLife,
+ * then the universe is advanced and the window covered by the grid is exported back into the current state.
+ * The universe is kept between calls, so cells outside the window are not lost.
+ *
+ * @param steps
+ *      The number of steps to advance the world forward.
+ *
+ * @param toroidal
+ *      Must be false, HashLife simulates an unbounded plane.
+ *
+ * @throws
+ *      std::runtime_error or sub-class if toroidal is true, or the rule has births on 0 neighbours.
+ */
+void World::advance_hashlife(int steps, bool toroidal) {
+    if (toroidal) {
+        throw std::runtime_error("The HashLife engine does not support toroidal worlds");
+    }
+    hashlife.set_rule(rule);
+    if (hashlife_stale) {
+        hashlife.set_grid(world);
+        hashlife_stale = false;
+    }
+    if (steps > 0) {
+        hashlife.advance(static_cast<unsigned long long>(steps));
+        generation += steps;
+    }
+    world = hashlife.to_grid(0, 0, world.get_width(), world.get_height());
+}
+
+/**
+ * World::advance_sparse(steps, toroidal)
+ *
+ * Private helper function to advance the world on an unbounded sparse plane.
+ * The current state grid is imported into the sparse world when it has changed outside of it,
+ * then the sparse world is advanced and the window covered by the grid is exported back into the current state.
+ * The sparse world is kept between calls, so cells outside the window are not lost.
+ *
+ * @param steps
+ *      The number of steps to advance the world forward.
+ *
+ * @param toroidal
+ *      Must be false, the sparse world is an unbounded plane.
+ *
+ * @throws
+ *      std::runtime_error or sub-class if toroidal is true, or the rule has births on 0 neighbours.
+ */
+void World::advance_sparse(int steps, bool toroidal) {
+    if (toroidal) {
+        throw std::runtime_error("The sparse engine does not support toroidal worlds");
+    }
+    if (sparse_stale) {
+        sparse = SparseWorld(world);
+        sparse_stale = false;
+    }
+    sparse.set_rule(rule);
+    sparse.advance(steps);
+    generation += std::max(steps, 0);
+    world = sparse.to_grid(0, 0, world.get_width(), world.get_height());
+}
+
+/**
+ * World::step_dense(toroidal)
+ *
+ * Private helper function to take one step with the scalar, packed, or SIMD engine, then count the generation
+ * and record the new state for cycle detection. Engine::PACKED expects the state to already be packed,
+ * and the scalar and SIMD engines expect it to already be padded, see World::pad_state().
+ *
+ * @param toroidal
+ *      If true then the step will consider the grid as a torus, where the left edge
+ *      wraps to the right edge and the top to the bottom.
+ */
+void World::step_dense(bool toroidal) {
+    bind_numa();
+    if (max_period > 0 && (history.empty() || toroidal != history_toroidal)) {
+        reset_history();
+        record_state(toroidal);
+    }
+
+    if (engine == Engine::PACKED) {
+        track_tiles ? step_packed_tiles(toroidal) : step_packed(toroidal);
+        world_stale = true;
+    } else if (engine == Engine::SIMD) {
+        fill_ring(toroidal);
+        step_simd();
+        world_stale = true;
+    } else {
+        fill_ring(toroidal);
+        for_each_band([&](int y0, int y1) { step_scalar(y0, y1); });
+        std::swap(padded, nextPadded);
+        world_stale = true;
+    }
+    generation++;
+
+    if (max_period > 0 && cycle_period == 0) {
+        record_state(toroidal);
+    }
+}
+
+/**
+ * mix_word(word, index)
+ *
+ * Scrambles a word of cells together with its position, using the splitmix64 finaliser,
+ * so that the same cells at different positions hash differently.
+ */
+static inline std::uint64_t mix_word(std::uint64_t word, std::uint64_t index) {
+    std::uint64_t z = word ^ (index * 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+/**
+ * World::snapshot_state()
+ *
+ * Private helper function to copy the current state into bit-packed words, one bit per cell and
+ * BitGrid::get_words_per_row() words per row, for keeping in the history of recent states.
+ * Engine::PACKED copies its words as they are, the other engines pack the rows of the padded state,
+ * so the copies only depend on the cells and not on the engine.
+ *
+ * @return
+ *      The rows of the current state one after another.
+ */
+std::vector<std::uint64_t> World::snapshot_state() {
+    const int width = world.get_width();
+    const int words = (width + 63) / 64;
+    std::vector<std::uint64_t> cells(static_cast<std::size_t>(words) * world.get_height());
+
+    if (engine == Engine::PACKED) {
+        for_each_range(world.get_height(), [&](int y0, int y1) {
+            for (int y = y0; y < y1; y++) {
+                std::copy(packed.row(y), packed.row(y) + words, cells.begin() + std::size_t(y) * words);
+            }
+        });
+        return cells;
+    }
+
+    for_each_range(world.get_height(), [&](int y0, int y1) {
+        for (int y = y0; y < y1; y++) {
+            const Cell *row = padded.row(y + 1) + 1;
+            std::uint64_t *out = cells.data() + std::size_t(y) * words;
+            for (int x = 0; x < width; x++) {
+                out[x / 64] |= std::uint64_t(row[x] & 1) << (x % 64);
+            }
+        }
+    });
+    return cells;
+}
+
+/**
+ * World::hash_state(cells)
+ *
+ * Private helper function to compute a 64 bit hash of a state copied by World::snapshot_state().
+ *
+ * The hash is the sum of every non-empty word of the state mixed with its position. Empty words are skipped,
+ * which keeps the hash of sparse boards cheap, and addition lets each band of rows be hashed on its own thread.
+ *
+ * @param cells
+ *      The bit-packed state.
+ *
+ * @return
+ *      The hash of the state.
+ */
+std::uint64_t World::hash_state(const std::vector<std::uint64_t> &cells) {
+    std::atomic<std::uint64_t> hash(0);
+    const int words = (world.get_width() + 63) / 64;
+    for_each_range(world.get_height(), [&](int y0, int y1) {
+        std::uint64_t sum = 0;
+        for (std::size_t i = std::size_t(y0) * words; i < std::size_t(y1) * words; i++) {
+            if (cells[i]) {
+                sum += mix_word(cells[i], i);
+            }
+        }
+        hash += sum;
+    });
+    return hash;
+}
+
+/**
+ * World::record_state(toroidal)
+ *
+ * Private helper function to look the current state up in the recent history, recording a cycle if it was
+ * seen before, otherwise adding it to the history. Only the last max_period states are kept.
+ *
+ * A state is only taken to have been seen before when the cells match, not just the hash,
+ * so two different states that happen to hash the same are never mistaken for a cycle.
+ *
+ * @param toroidal
+ *      The topology the states were stepped with. The history is only valid for one topology.
+ */
+void World::record_state(bool toroidal) {
+    history_toroidal = toroidal;
+    std::vector<std::uint64_t> cells = snapshot_state();
+    const std::uint64_t hash = hash_state(cells);
+
+    // The history is in order of generation, so each candidate is found by a binary search
+    auto candidates = history.equal_range(hash);
+    for (auto it = candidates.first; it != candidates.second; it++) {
+        auto earlier = std::lower_bound(history_order.begin(), history_order.end(), it->second,
+                                        [](const HistoryState &state, long long gen) { return state.generation < gen; });
+        if (earlier != history_order.end() && earlier->generation == it->second && earlier->cells == cells) {
+            cycle_start = it->second;
+            cycle_period = static_cast<int>(generation - it->second);
+            return;
+        }
+    }
+
+    history.insert(std::make_pair(hash, generation));
+    history_order.push_back(HistoryState{generation, hash, std::move(cells)});
+    if (history_order.size() > static_cast<std::size_t>(max_period)) {
+        const HistoryState &oldest = history_order.front();
+        auto matches = history.equal_range(oldest.hash);
+        for (auto it = matches.first; it != matches.second; it++) {
+            if (it->second == oldest.generation) {
+                history.erase(it);
+                break;
+            }
+        }
+        history_order.pop_front();
+    }
+}
+
+/**
+ * World::reset_history()
+ *
+ * Private helper function to forget the recent states and any detected cycle,
+ * used whenever the state or the way it evolves is changed from outside of stepping.
+ */
+void World::reset_history() {
+    history.clear();
+    history_order.clear();
+    cycle_start = -1;
+    cycle_period = 0;
+}
+
+/**
+ * World::get_generation()
+ *
+ * Gets the number of steps taken since the world was constructed, including steps skipped by cycle detection.
+ *
+ * @return
+ *      The current generation.
+ */
+long long World::get_generation() const {
+    return generation;
+}
+
+/**
+ * World::set_cycle_detection(max_period, stop_early)
+ *
+ * Enables detecting when the world settles into a still life or an oscillator. After every step a 64 bit hash
+ * of the state is compared against the hashes of the previous max_period states. A match is confirmed by comparing
+ * the cells of the two states, and then means the state repeats, with a period of the distance between the two
+ * generations. A still life has a period of 1.
+ *
+ * Each step adds one pass over the state, to copy it bit-packed and hash it, and the copies of the previous
+ * max_period states are kept, taking max_period bits per cell of memory. It is only available for the scalar,
+ * packed, and SIMD engines, as the unbounded engines only show a window of their state.
+ *
+ * @example
+ *
+ *      // Run a soup for up to a million steps, finishing as soon as it settles into a cycle of at most 64
+ *      World world(soup);
+ *      world.set_cycle_detection(64);
+ *      world.advance(1000000);
+ *      if (world.get_cycle_period() > 0) {
+ *          std::cout << "Period " << world.get_cycle_period() << " from " << world.get_cycle_start() << std::endl;
+ *      }
+ *
+ * @param max_period
+ *      The longest period to look for. 0 disables cycle detection.
+ *
+ * @param stop_early
+ *      Optional parameter. If true then World::advance(steps, toroidal) skips the remaining whole periods
+ *      once a cycle is found. Defaults to true.
+ *
+ * @throws
+ *      std::runtime_error or sub-class if max_period is negative.
+ */
+void World::set_cycle_detection(int max_period, bool stop_early) {
+    if (max_period < 0) {
+        throw std::runtime_error("The maximum period cannot be negative");
+    }
+    this->max_period = max_period;
+    this->stop_on_cycle = stop_early;
+    reset_history();
+}
+
+/**
+ * World::get_cycle_period()
+ *
+ * Gets the period of the cycle the world has settled into, if one was detected.
+ *
+ * @return
+ *      The period, 1 for a still life, or 0 if no cycle has been detected.
+ */
+int World::get_cycle_period() const {
+    return cycle_period;
+}
+
+/**
+ * World::get_cycle_start()
+ *
+ * Gets the first generation of the detected cycle, counted from when detection began.
+ *
+ * @return
+ *      The generation the cycle began, or -1 if no cycle has been detected.
+ */
+long long World::get_cycle_start() const {
+    return cycle_start;
 }
\ No newline at end of file
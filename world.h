@@ -10,24 +10,137 @@
  */
 #pragma once
 
+#include <atomic>
+#include <functional>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 #include "grid.h"
+#include "bitgrid.h"
+#include "hashlife.h"
+#include "numa.h"
+#include "rule.h"
+#include "simd.h"
+#include "sparse_world.h"
+#include "thread_pool.h"
 // Add the minimal number of includes you need in order to declare the class.
 // #include ...
 
+/**
+ * The stepping engines a World can use to apply the rules.
+ *      - Engine::SCALAR updates one cell at a time on the Grid state, without branching on the edges.
+ *      - Engine::PACKED updates 64 cells at a time on a bit-packed copy of the state.
+ *      - Engine::SIMD updates 16 to 64 cells per instruction on the Grid state, using the fastest
+ *        vector kernel the CPU supports.
+ *      - Engine::HASHLIFE simulates an unbounded plane with HashLife, of which the Grid state is a window.
+ *      - Engine::SPARSE simulates an unbounded plane as a sparse map of tiles, of which the Grid state is a window.
+ */
+enum class Engine {
+    SCALAR,
+    PACKED,
+    SIMD,
+    HASHLIFE,
+    SPARSE
+};
+
 /**
  * Declare the structure of the World class for representing a 2d grid world.
  *
- * A World holds two equally sized Grid objects for the current state and next state.
- *      - These buffers should be swapped using std::swap after each update step.
+ * A World holds the current state in a Grid object.
+ *      - The scalar and SIMD engines step a copy padded with a one cell ring, and the packed engine a bit-packed
+ *        copy, each with an equally sized buffer for the next state that is swapped using std::swap after each step.
+ *
+ * The const methods may be called from several threads at once, as long as no thread is stepping or changing
+ * the world meanwhile. The first of them after a step may bring the current state grid up to date, which is
+ * done once behind a mutex.
  */
 class World {
     // How to draw an owl:
     //      Step 1. Draw a circle.
     //      Step 2. Draw the rest of the owl.
 private:
-    Grid world;
-    Grid nextWorld;
+    // Behind the padded or packed state while world_stale, brought up to date by World::sync_state() before it is read
+    mutable Grid world;
+    mutable std::atomic<bool> world_stale;
+    mutable std::mutex sync_mutex;
+    // The current and next state with a one cell ring around them, stepped by the scalar and SIMD engines
+    Grid padded;
+    Grid nextPadded;
+    bool padded_stale;
+
+    Engine engine;
+    Rule rule;
+    BitGrid packed;
+    BitGrid nextPacked;
+    bool packed_stale;
+    Simd::RowKernel simd_kernel;
+    std::unique_ptr<ThreadPool> pool;
+    // The node of each thread of the pool when pinned, and the buffers last bound to those nodes
+    bool numa;
+    std::vector<int> thread_nodes;
+    std::vector<const void*> numa_bound;
+    // The CPUs the calling thread could run on before it was pinned, restored when NUMA mode ends
+    std::vector<int> caller_affinity;
+    std::thread::id caller;
+    HashLife hashlife;
+    bool hashlife_stale;
+    SparseWorld sparse;
+    bool sparse_stale;
+
+    // Flags are chars rather than bools so that tiles can be updated from several threads at once
+    bool track_tiles;
+    bool tiles_toroidal;
+    int temporal_block;
+    std::size_t temporal_block_bytes;
+    std::vector<char> tile_changed;
+    std::vector<char> next_tile_changed;
+    std::vector<int> active_list;
+    int active_tiles;
+
+    // A recent state, bit-packed, kept so that a matching hash can be confirmed by comparing the cells
+    struct HistoryState {
+        long long generation;
+        std::uint64_t hash;
+        std::vector<std::uint64_t> cells;
+    };
+
+    // Hashes of recent states, for spotting when the world returns to an earlier state
+    long long generation;
+    int max_period;
+    bool stop_on_cycle;
+    bool history_toroidal;
+    std::unordered_multimap<std::uint64_t, long long> history;
+    std::deque<HistoryState> history_order;
+    long long cycle_start;
+    int cycle_period;
+
+    void copy_from(const World &other);
+    void pack_state();
+    void unpack_state() const;
+    void pad_state();
+    void sync_state() const;
+    void apply_numa();
+    void bind_numa();
+    void for_each_band(const std::function<void(int, int)> &body) const;
+    void for_each_range(int count, const std::function<void(int, int)> &body) const;
+    void for_each_task(int count, int grain, const std::function<void(int, int)> &body) const;
+    void fill_ring(bool toroidal);
+    void step_scalar(int y0, int y1);
+    void step_packed(bool toroidal);
+    void step_packed_blocked(int generations, bool toroidal);
+    void step_packed_tiles(bool toroidal);
+    void step_simd();
+    void step_dense(bool toroidal);
+    std::vector<std::uint64_t> snapshot_state();
+    std::uint64_t hash_state(const std::vector<std::uint64_t> &cells);
+    void record_state(bool toroidal);
+    void reset_history();
+    void advance_hashlife(int steps, bool toroidal);
+    void advance_sparse(int steps, bool toroidal);
 
 public:
    
@@ -35,12 +148,15 @@ public:
     World(int square_size);
     World(int width, int height);
     World(Grid initial_state);
+    World(const World &other);
+    World& operator=(const World &other);
+    ~World();
 
     int get_width() const;
     int get_height() const;
-    int get_total_cells() const;
-    int get_alive_cells() const;
-    int get_dead_cells() const;
+    long long get_total_cells() const;
+    long long get_alive_cells() const;
+    long long get_dead_cells() const;
 
     void resize(int square_size);
     void resize(int new_width, int new_height);
@@ -49,4 +165,29 @@ public:
     void step(bool toroidal = false);
     void advance(int steps, bool toroidal = false);
     const Grid& get_state() const; 
+
+    void set_engine(Engine engine);
+    Engine get_engine() const;
+    void set_rule(const Rule &rule);
+    const Rule& get_rule() const;
+    void set_simd_level(Simd::Level level);
+    void set_threads(int threads);
+    int get_threads() const;
+    ThreadPool::Stats get_thread_stats() const;
+    void reset_thread_stats();
+    void set_numa(bool enabled);
+    bool get_numa() const;
+    std::vector<Numa::NodeStats> get_node_stats() const;
+    void set_hashlife_memory(std::size_t bytes);
+    void set_tile_tracking(bool enabled);
+    int get_active_tiles() const;
+    int get_total_tiles() const;
+    void set_temporal_blocking(int generations);
+    int get_temporal_blocking() const;
+    void set_temporal_block_bytes(std::size_t bytes);
+    std::size_t get_temporal_block_bytes() const;
+    long long get_generation() const;
+    void set_cycle_detection(int max_period, bool stop_early = true);
+    int get_cycle_period() const;
+    long long get_cycle_start() const;
 };
\ No newline at end of file
@@ -10,6 +10,13 @@
  *                terminated by a newline character.
  *              - (space) ' ' is Cell::DEAD, (hash) '#' is Cell::ALIVE.
  *
+ *      - Grids can be loaded from and saved to the run length encoded .rle format used by the Life community,
+ *        optionally along with the rule of the pattern.
+ *
+ *      - Patterns can be loaded from and saved to the macrocell .mc quadtree format written by Golly.
+ *          - Macrocell files load into a HashLife universe or a SparseWorld, never a dense Grid,
+ *            so patterns far larger than memory as a bitmap can be run.
+ *
  *      - Grids can be loaded from and saved to an binary file format.
  *          - Binary files are composed of:
  *              - a 4 byte int representing the grid width
@@ -17,6 +24,13 @@
  *              - followed by (width * height) number of individual bits in C-style row/column format,
  *                padded with zero or more 0 bits.
  *              - a 0 bit should be considered Cell::DEAD, a 1 bit should be considered Cell::ALIVE.
+ *              - the first cell of each byte is held in its lowest bit.
+ *          - Binary files are loaded through memory mapped windows, and can be loaded straight into a BitGrid.
+ *
+ *      - Grids can be saved to and loaded from a v2 binary snapshot, see Zoo::save_snapshot.
+ *          - Snapshots hold the rule and generation, and the grid as independently compressed and checksummed tiles.
+ *          - Zoo::load_binary reads both versions, telling them apart by the magic bytes at the start of a snapshot.
+ *          - A rectangle of either version can be read without reading the rest of the file, see Zoo::load_region.
  *
  * @author 959133
  * @date March, 2020
@@ -25,8 +39,29 @@
 
 // Include the minimal number of headers needed to support your implementation.
 // #include ...
+#include "mapped_file.h"
+#include "rule.h"
+
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
-#include <bitset>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifdef GOL_HAVE_LZ4
+#include <lz4.h>
+#endif
+#ifdef GOL_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
 /**
  * Zoo::glider()
  *
@@ -128,12 +163,31 @@ Grid Zoo::light_weight_spaceship() {
     return light_weight_spaceship;
 };
 
+/**
+ * ascii_row_valid(text, width)
+ *
+ * Tests whether every character of a row is the ALIVE or DEAD character. The test has no branches,
+ * so the compiler can check many characters per instruction.
+ */
+static bool ascii_row_valid(const char *text, int width) {
+    unsigned char invalid = 0;
+    for (int x = 0; x < width; x++) {
+        invalid |= static_cast<unsigned char>((text[x] != static_cast<char>(Cell::DEAD))
+                                              & (text[x] != static_cast<char>(Cell::ALIVE)));
+    }
+    return !invalid;
+}
+
 /**
  * Zoo::load_ascii(path)
  *
  * Load an ascii file and parse it as a grid of cells.
  * Should be implemented using std::ifstream.
  *
+ * The file is read in a single call and parsed a line at a time. As the characters of an ascii file
+ * are the values of the cells, each row is checked with ascii_row_valid(text, width) and copied straight
+ * into the grid. Lines may end in "\n" or "\r\n", and the last line need not end in a newline.
+ *
  * @example
  *
  *      // Load an ascii file from a directory
@@ -153,41 +207,55 @@ Grid Zoo::light_weight_spaceship() {
  *          - The character for a cell is not the ALIVE or DEAD character.
  */
 Grid Zoo::load_ascii(std::string path){
-    std::ifstream inputFile(path);
+    std::ifstream inputFile(path, std::ios_base::binary);
     if (!inputFile) {
         throw std::runtime_error("File not found");
     }
+    inputFile.seekg(0, std::ios_base::end);
+    std::vector<char> text(static_cast<std::size_t>(inputFile.tellg()));
+    inputFile.seekg(0, std::ios_base::beg);
+    inputFile.read(text.data(), static_cast<std::streamsize>(text.size()));
 
-    if (!inputFile.is_open()) {
-    return 1;
-    }
+    const char *position = text.data();
+    const char *end = position + text.size();
 
-    int readWidth;
-    int readHeight;
+    // Gets the next line without its line ending, or false at the end of the file
+    auto line = [&](const char *&start, int &length) {
+        if (position == end) {
+            return false;
+        }
+        const char *newline = static_cast<const char*>(std::memchr(position, '\n', static_cast<std::size_t>(end - position)));
+        const char *stop = newline ? newline : end;
+        start = position;
+        position = newline ? newline + 1 : end;
+        if (stop > start && stop[-1] == '\r') {
+            stop--;
+        }
+        if (stop - start > INT_MAX) {
+            throw std::runtime_error("Malformed");
+        }
+        length = static_cast<int>(stop - start);
+        return true;
+    };
 
-    inputFile >> readWidth;
-    inputFile >> readHeight;
-    if (readWidth < 0 || readHeight < 0) {
+    const char *start;
+    int length;
+    int readWidth, readHeight;
+    char extra;
+    if (!line(start, length)
+            || std::sscanf(std::string(start, length).c_str(), "%d %d %c", &readWidth, &readHeight, &extra) != 2
+            || readWidth < 0 || readHeight < 0
+            || static_cast<std::uint64_t>(readWidth) * static_cast<std::uint64_t>(readHeight) > INT_MAX) {
         throw std::runtime_error("Incorrect height or width.");
     }
+
+    static_assert(sizeof(Cell) == sizeof(char), "Cells must be stored as their characters");
     Grid newGrid(readWidth, readHeight);
-    char readCell;
     for (int y = 0; y < readHeight; y++) {
-        for (int x = 0; x < readWidth; x++) {
-            if(!inputFile.eof()) {
-                inputFile.get (readCell);
-                if (readCell == '\n') {
-                    readCell = inputFile.get();
-                }
-                if (readCell == Cell::DEAD) {
-                    newGrid.set(x,y, Cell::DEAD);
-                } else if (readCell == Cell::ALIVE) { 
-                    newGrid.set(x,y, Cell::ALIVE);
-                } else {
-                    throw std::runtime_error("Malformed");
-                }
-            }
+        if (!line(start, length) || length != readWidth || !ascii_row_valid(start, readWidth)) {
+            throw std::runtime_error("Malformed");
         }
+        std::memcpy(newGrid.grid.data() + static_cast<std::size_t>(y) * readWidth, start, static_cast<std::size_t>(readWidth));
     }
     return newGrid;
 }
@@ -231,144 +299,1777 @@ void Zoo::save_ascii(std::string path, Grid grid) {
     outputFile << "\n";
 
     for (int y = 0; y < grid.get_height(); y++) {
-        for (int x = 0; x < grid.get_width(); x++) {
-            char cell = grid.get(x,y);
-            outputFile << cell;
-        }
+        outputFile.write(reinterpret_cast<const char*>(grid.row(y)), grid.get_width());
         outputFile << "\n";
     }
     outputFile.close();
 }
 
 /**
- * Zoo::load_binary(path)
+ * ChunkReader
  *
- * Load a binary file and parse it as a grid of cells.
- * Should be implemented using std::ifstream.
+ * Reads a file one character at a time out of a 64 KiB buffer, refilled with one large read,
+ * so parsers can work character by character without a stream call per character.
+ */
+class ChunkReader {
+private:
+    std::ifstream &file;
+    std::vector<char> buffer;
+    std::size_t position;
+    std::size_t length;
+
+public:
+    static const std::size_t CHUNK = std::size_t(1) << 16;
+
+    explicit ChunkReader(std::ifstream &file) : file(file), buffer(CHUNK), position(0), length(0) {
+    }
+
+    // Gets the next character, or -1 at the end of the file
+    int next() {
+        if (position == length) {
+            file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            length = static_cast<std::size_t>(file.gcount());
+            position = 0;
+            if (length == 0) {
+                return -1;
+            }
+        }
+        return static_cast<unsigned char>(buffer[position++]);
+    }
+
+    // Reads up to the next newline, which is consumed but not stored. Returns false at the end of the file
+    bool line(std::string &text) {
+        text.clear();
+        int c = next();
+        if (c < 0) {
+            return false;
+        }
+        for (; c >= 0 && c != '\n'; c = next()) {
+            if (c != '\r') {
+                text += static_cast<char>(c);
+            }
+        }
+        return true;
+    }
+};
+
+/**
+ * trim(text)
+ *
+ * Removes the spaces and tabs from both ends of some text.
+ */
+static std::string trim(const std::string &text) {
+    std::size_t first = text.find_first_not_of(" \t");
+    std::size_t last = text.find_last_not_of(" \t");
+    return (first == std::string::npos) ? std::string() : text.substr(first, last - first + 1);
+}
+
+/**
+ * parse_file_rule(text)
+ *
+ * Parses the rule of a pattern file, dropping the ":T" or ":P" topology suffix Golly adds for bounded grids,
+ * i.e. "B3/S23:T100,100". A rule that still cannot be parsed falls back to B3/S23 with a warning,
+ * so that the cells of the file can still be read.
+ */
+static Rule parse_file_rule(const std::string &text) {
+    const std::string rulestring = trim(text.substr(0, text.find(':')));
+    try {
+        return Rule(rulestring);
+    } catch (const std::runtime_error &ex) {
+        std::cerr << "Warning: " << ex.what() << ", using B3/S23 instead" << std::endl;
+        return Rule();
+    }
+}
+
+/**
+ * parse_rle_header(header, width, height, rule)
+ *
+ * Parses the "x = m, y = n, rule = B3/S23" header line of an RLE file. The rule is optional,
+ * and runs to the end of the line, as a topology suffix may itself hold a comma.
+ */
+static void parse_rle_header(const std::string &header, int &width, int &height, Rule &rule) {
+    bool has_width = false, has_height = false;
+    std::size_t start = 0;
+    while (start < header.size()) {
+        std::size_t equals = header.find('=', start);
+        if (equals == std::string::npos) {
+            throw std::runtime_error("Malformed RLE header");
+        }
+        const std::string key = trim(header.substr(start, equals - start));
+        std::size_t end = (key == "rule") ? std::string::npos : header.find(',', equals);
+        if (end == std::string::npos) {
+            end = header.size();
+        }
+        const std::string value = trim(header.substr(equals + 1, end - equals - 1));
+        start = end + 1;
+
+        if (key == "x" || key == "y") {
+            if (value.empty() || value.size() > 10 || value.find_first_not_of("0123456789") != std::string::npos
+                    || std::stoll(value) > INT_MAX) {
+                throw std::runtime_error("Incorrect height or width.");
+            }
+            (key == "x" ? width : height) = static_cast<int>(std::stoll(value));
+            (key == "x" ? has_width : has_height) = true;
+        } else if (key == "rule") {
+            rule = parse_file_rule(value);
+        }
+    }
+    if (!has_width || !has_height) {
+        throw std::runtime_error("Malformed RLE header");
+    }
+    if (static_cast<long long>(width) * height > INT_MAX) {
+        throw std::runtime_error("Incorrect height or width.");
+    }
+}
+
+/**
+ * Zoo::load_rle(path)
+ *
+ * Load a run length encoded .rle file and parse it as a grid of cells, ignoring any rule in the file.
+ * See Zoo::load_rle(path, rule).
  *
  * @example
  *
- *      // Load an binary file from a directory
- *      Grid grid = Zoo::load_binary("path/to/file.bgol");
+ *      // Load a pattern from the archive
+ *      Grid grid = Zoo::load_rle("path/to/gosper_glider_gun.rle");
+ *
+ * @param path
+ *      The std::string path to the file to read in.
+ *
+ * @return
+ *      Returns the parsed grid.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if the file cannot be opened or is malformed.
+ */
+Grid Zoo::load_rle(std::string path) {
+    Rule rule;
+    return load_rle(path, rule);
+}
+
+/**
+ * Zoo::load_rle(path, rule)
+ *
+ * Load a run length encoded .rle file and parse it as a grid of cells.
+ * https://www.conwaylife.com/wiki/Run_Length_Encoded
+ *
+ *      - Lines starting with '#' before the header are comments and are skipped.
+ *      - The header line gives the size of the pattern, "x = m, y = n", and optionally its rule, "rule = B36/S23".
+ *          - The rule may be a name, "Life" or "HighLife", and may end in a topology suffix such as ":T100,100",
+ *            which is ignored. A rule that cannot be parsed is replaced by B3/S23 with a warning.
+ *      - The pattern follows as runs of cells, each an optional count and a tag.
+ *          - 'b' (or '.') is a run of Cell::DEAD, any other letter is a run of Cell::ALIVE.
+ *          - '$' ends a row, a count before it skipping that many rows.
+ *          - '!' ends the pattern. Cells not given are Cell::DEAD.
+ *
+ * The file is parsed in a single streaming pass over 64 KiB chunks, writing runs of alive cells straight
+ * into the grid storage. The only allocations are the grid and the read buffer.
+ *
+ * @example
+ *
+ *      // Load a pattern along with the rule it was designed for
+ *      Rule rule;
+ *      Grid grid = Zoo::load_rle("path/to/replicator.rle", rule);
+ *      World world(grid);
+ *      world.set_rule(rule);
  *
  * @param path
  *      The std::string path to the file to read in.
  *
+ * @param rule
+ *      Set to the rule given in the header, or B3/S23 when the header has no rule or it cannot be parsed.
+ *
  * @return
  *      Returns the parsed grid.
  *
  * @throws
  *      Throws std::runtime_error or sub-class if:
  *          - The file cannot be opened.
- *          - The file ends unexpectedly.
+ *          - The header is missing or malformed, or gives a negative or overly large size.
+ *          - The pattern contains an unexpected character or places an alive cell outside of its size.
  */
-Grid Zoo::load_binary(std::string path) {
+Grid Zoo::load_rle(std::string path, Rule &rule) {
     std::ifstream inputFile(path, std::ios_base::binary);
     if (!inputFile) {
         throw std::runtime_error("File cannot be opened");
     }
-    
-    Grid newGrid;
-    int readWidth;
-    int readHeight;
-    
-    inputFile.read((reinterpret_cast<char*>(&readWidth)),sizeof(int));
-    inputFile.read((reinterpret_cast<char*>(&readHeight)),sizeof(int));
-    newGrid.resize(readWidth,readHeight);
-    newGrid.grid.clear();
-
-    inputFile.seekg (0, inputFile.end);
-    int length = inputFile.tellg();
-    inputFile.seekg (0, inputFile.beg);
-
-    if(inputFile) {
-        char * buffer = new char [length];
-        inputFile.read (buffer,length);
-        int total = 0;
-        for (int i=8;i < length; i++) {
-            
-            std::bitset<8> byte (buffer[i]);
-            std::string newString = byte.to_string();
-            for (int j = 7; j >= 0; j--){
-                if (total < newGrid.get_total_cells()) {
-                    
-                    if(newString[j] == '1') {
-                        newGrid.grid.push_back(Cell::ALIVE);
-                    } else if (newString[j] == '0') {
-                        newGrid.grid.push_back(Cell::DEAD);
-                    } else {
-                        throw std::runtime_error("Malformed");
-                    }
+    ChunkReader reader(inputFile);
+
+    std::string header;
+    bool found = false;
+    while (!found && reader.line(header)) {
+        std::size_t first = header.find_first_not_of(" \t");
+        found = first != std::string::npos && header[first] != '#';
+    }
+    if (!found) {
+        throw std::runtime_error("Malformed RLE header");
+    }
+    int width = 0, height = 0;
+    rule = Rule();
+    parse_rle_header(header, width, height, rule);
+
+    Grid grid(width, height);
+    Cell *cells = grid.grid.data();
+    long long x = 0, y = 0, run = 0;
+    for (int c = reader.next(); c >= 0 && c != '!'; c = reader.next()) {
+        if (c >= '0' && c <= '9') {
+            run = std::min<long long>(run * 10 + (c - '0'), INT_MAX);
+            continue;
+        }
+        const long long count = (run == 0) ? 1 : run;
+        if (c == 'b' || c == '.') {
+            x += count;
+        } else if (c == '$') {
+            y += count;
+            x = 0;
+        } else if (std::isalpha(c)) {
+            if (x + count > width || y >= height) {
+                throw std::runtime_error("Malformed RLE pattern, cells outside of the pattern size");
+            }
+            std::fill(cells + static_cast<std::size_t>(y) * width + x, cells + static_cast<std::size_t>(y) * width + x + count, Cell::ALIVE);
+            x += count;
+        } else if (std::isspace(c)) {
+            continue;
+        } else {
+            throw std::runtime_error("Malformed RLE pattern");
+        }
+        run = 0;
+    }
+    return grid;
+}
+
+/**
+ * Zoo::save_rle(path, grid, rule)
+ *
+ * Save a grid as a run length encoded .rle file, see Zoo::load_rle(path, rule) for the format.
+ * Rows are encoded as runs of 'b' and 'o', trailing dead cells of a row and trailing empty rows are left out,
+ * and lines are wrapped at 70 characters. The file is built in memory and written with a single call.
+ *
+ * @example
+ *
+ *      // Save the state of a HighLife world
+ *      Zoo::save_rle("path/to/file.rle", world.get_state(), world.get_rule());
+ *
+ * @param path
+ *      The std::string path to the file to write to.
+ *
+ * @param grid
+ *      The grid to be written out to file.
+ *
+ * @param rule
+ *      Optional parameter. The rule written to the header. Defaults to B3/S23.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if the file cannot be opened.
+ */
+void Zoo::save_rle(std::string path, const Grid &grid, const Rule &rule) {
+    std::ofstream outputFile(path, std::ios_base::binary);
+    if (!outputFile.is_open()) {
+        throw std::runtime_error("File cannot be opened");
+    }
+    const int width = grid.get_width();
+    const int height = grid.get_height();
+
+    std::string text = "x = " + std::to_string(width) + ", y = " + std::to_string(height)
+                     + ", rule = " + rule.to_string() + "\n";
+    std::size_t line_start = text.size();
+    auto emit = [&](long long count, char tag) {
+        char token[24];
+        int length = sizeof(token);
+        token[--length] = tag;
+        for (long long digits = (count > 1) ? count : 0; digits > 0; digits /= 10) {
+            token[--length] = static_cast<char>('0' + digits % 10);
+        }
+        if (text.size() - line_start + (sizeof(token) - length) > 70) {
+            text += '\n';
+            line_start = text.size();
+        }
+        text.append(token + length, sizeof(token) - length);
+    };
+
+    const Cell *cells = grid.grid.data();
+    long long rows_pending = 0;
+    for (int y = 0; y < height; y++) {
+        const Cell *row = cells + static_cast<std::size_t>(y) * width;
+        int end = width;
+        while (end > 0 && row[end - 1] != Cell::ALIVE) {
+            end--;
+        }
+        if (end > 0) {
+            if (rows_pending > 0) {
+                emit(rows_pending, '$');
+            }
+            rows_pending = 0;
+            for (int x = 0; x < end; ) {
+                const Cell value = (row[x] == Cell::ALIVE) ? Cell::ALIVE : Cell::DEAD;
+                int next = x;
+                while (next < end && ((row[next] == Cell::ALIVE) == (value == Cell::ALIVE))) {
+                    next++;
+                }
+                emit(next - x, value == Cell::ALIVE ? 'o' : 'b');
+                x = next;
+            }
+        }
+        rows_pending++;
+    }
+    emit(1, '!');
+    text += '\n';
+    outputFile.write(text.data(), static_cast<std::streamsize>(text.size()));
+}
+
+/**
+ * MACROCELL_MAX_LEVEL
+ *
+ * The largest node level of a macrocell file that fits the 64 bit coordinates of HashLife.
+ */
+static const int MACROCELL_MAX_LEVEL = 62;
+
+/**
+ * read_macrocell(path, life, rule)
+ *
+ * Parses a macrocell file into the nodes of a HashLife universe, setting the rule from its "#R" line.
+ */
+static void read_macrocell(const std::string &path, HashLife &life, Rule &rule) {
+    typedef HashLife::Node Node;
+
+    std::ifstream inputFile(path, std::ios_base::binary);
+    if (!inputFile) {
+        throw std::runtime_error("File cannot be opened");
+    }
+    ChunkReader reader(inputFile);
+
+    std::string line;
+    if (!reader.line(line) || line.compare(0, 4, "[M2]") != 0) {
+        throw std::runtime_error("Malformed macrocell file, expected a [M2] header");
+    }
+
+    // Builds the node for the square of 2^level cells at (x0, y0) of an 8x8 bitmap
+    bool bitmap[8][8];
+    std::function<const Node*(int, int, int)> square = [&](int x0, int y0, int level) -> const Node* {
+        if (level == 0) {
+            return life.leaf(bitmap[y0][x0] ? Cell::ALIVE : Cell::DEAD);
+        }
+        int half = 1 << (level - 1);
+        return life.join(square(x0, y0, level - 1), square(x0 + half, y0, level - 1),
+                         square(x0, y0 + half, level - 1), square(x0 + half, y0 + half, level - 1));
+    };
 
-                    total++;
+    // Node 0 stands for an empty node of whatever level is needed
+    std::vector<const Node*> nodes(1, nullptr);
+    rule = Rule();
+    while (reader.line(line)) {
+        if (line.empty()) {
+            continue;
+        }
+        if (line[0] == '#') {
+            if (line.compare(0, 2, "#R") == 0) {
+                rule = parse_file_rule(line.substr(2));
+            }
+            continue;
+        }
+
+        if (line[0] == '.' || line[0] == '*' || line[0] == '$') {
+            std::memset(bitmap, 0, sizeof(bitmap));
+            int x = 0, y = 0;
+            for (char c : line) {
+                if (c == '$') {
+                    x = 0;
+                    y++;
+                } else if ((c == '.' || c == '*') && x < 8 && y < 8) {
+                    bitmap[y][x++] = (c == '*');
+                } else {
+                    throw std::runtime_error("Malformed macrocell leaf");
                 }
             }
+            nodes.push_back(square(0, 0, 3));
+            continue;
         }
-        if (total != newGrid.get_total_cells()) {
-            throw std::runtime_error("Malformed file");
+
+        long long level, children[4];
+        char extra;
+        if (std::sscanf(line.c_str(), "%lld %lld %lld %lld %lld %c", &level, &children[0], &children[1],
+                        &children[2], &children[3], &extra) != 5
+                || level < 4 || level > MACROCELL_MAX_LEVEL) {
+            throw std::runtime_error("Malformed macrocell node");
+        }
+        const Node *quadrants[4];
+        for (int i = 0; i < 4; i++) {
+            if (children[i] < 0 || children[i] >= static_cast<long long>(nodes.size())) {
+                throw std::runtime_error("Malformed macrocell node, child does not exist");
+            }
+            quadrants[i] = children[i] ? nodes[children[i]] : life.empty(static_cast<int>(level) - 1);
+            if (quadrants[i]->level != level - 1) {
+                throw std::runtime_error("Malformed macrocell node, child is the wrong size");
+            }
         }
-        delete[] buffer;
-        inputFile.close();
+        nodes.push_back(life.join(quadrants[0], quadrants[1], quadrants[2], quadrants[3]));
     }
-    return newGrid;
+
+    life.set_rule(rule);
+    life.set_root(nodes.size() > 1 ? nodes.back() : life.empty(3));
 }
 
 /**
- * Zoo::save_binary(path, grid)
+ * Zoo::load_macrocell(path)
  *
- * Save a grid as an binary .bgol file according to the specified file format.
- * Should be implemented using std::ofstream.
+ * Load a macrocell .mc file into a HashLife universe, ignoring any rule in the file.
+ * See Zoo::load_macrocell(path, rule).
+ *
+ * @param path
+ *      The std::string path to the file to read in.
+ *
+ * @return
+ *      Returns the universe.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if the file cannot be opened or is malformed.
+ */
+HashLife Zoo::load_macrocell(std::string path) {
+    Rule rule;
+    HashLife life = load_macrocell(path, rule);
+    life.set_rule(Rule());
+    return life;
+}
+
+/**
+ * Zoo::load_macrocell(path, rule)
+ *
+ * Load a macrocell .mc file, the quadtree format written by Golly, into a HashLife universe.
+ * https://www.conwaylife.com/wiki/Macrocell
+ *
+ *      - The first line is "[M2]", optionally followed by the writing program.
+ *      - Lines starting with '#' are comments, except "#R rule" which gives the rule.
+ *          - The rule is read as in Zoo::load_rle(path, rule), so names and topology suffixes are accepted,
+ *            and a rule that cannot be parsed is replaced by B3/S23 with a warning.
+ *      - Every other line defines the next node, numbered from 1, and the last node is the whole pattern.
+ *          - An 8x8 node is a bitmap of '.' (dead) and '*' (alive) with '$' ending each row.
+ *            Trailing dead cells and rows are left out.
+ *          - A larger node is "level nw ne sw se", the node being 2^level cells wide, and the
+ *            children being the numbers of earlier nodes, or 0 for an empty child.
+ *
+ * Nodes are read straight into the canonical node cache of the universe, so a pattern that would
+ * cover terabytes as a Grid costs only as much memory as its distinct nodes. The root is centred on the origin.
  *
  * @example
  *
- *      // Make an 8x8 grid
- *      Grid grid(8);
+ *      // Run a huge pattern a trillion generations without ever expanding it
+ *      Rule rule;
+ *      HashLife life = Zoo::load_macrocell("path/to/caterpillar.mc", rule);
+ *      life.advance(1000000000000ULL);
  *
- *      // Save a grid to an binary file in a directory
- *      try {
- *          Zoo::save_binary("path/to/file.bgol", grid);
- *      }
- *      catch (const std::exception &ex) {
- *          std::cerr << ex.what() << std::endl;
- *      }
+ * @param path
+ *      The std::string path to the file to read in.
+ *
+ * @param rule
+ *      Set to the rule given by the file, or B3/S23 when the file has no rule or it cannot be parsed.
+ *      The universe also uses it.
+ *
+ * @return
+ *      Returns the universe.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if:
+ *          - The file cannot be opened.
+ *          - The header is missing, or a node line is malformed or refers to a missing or wrongly sized node.
+ *          - A node is too large for 64 bit coordinates.
+ *          - The rule has births on 0 neighbours.
+ */
+HashLife Zoo::load_macrocell(std::string path, Rule &rule) {
+    HashLife life;
+    read_macrocell(path, life, rule);
+    return life;
+}
+
+/**
+ * Zoo::load_macrocell_sparse(path, rule)
+ *
+ * Load a macrocell .mc file into a sparse tiled world, for patterns that are large in extent but
+ * have few alive cells. Only the branches of the quadtree holding alive cells are visited.
+ * See Zoo::load_macrocell(path, rule) for the format.
+ *
+ * @example
+ *
+ *      // Step a pattern one generation at a time on the sparse plane
+ *      Rule rule;
+ *      SparseWorld sparse = Zoo::load_macrocell_sparse("path/to/pattern.mc", rule);
+ *      sparse.advance(100);
+ *
+ * @param path
+ *      The std::string path to the file to read in.
+ *
+ * @param rule
+ *      Set to the rule given by the file, or B3/S23 when the file has no rule. The world also uses it.
+ *
+ * @return
+ *      Returns the sparse world, with the root of the file centred on the origin.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class in the same cases as Zoo::load_macrocell(path, rule).
+ */
+SparseWorld Zoo::load_macrocell_sparse(std::string path, Rule &rule) {
+    typedef HashLife::Node Node;
+
+    HashLife life;
+    read_macrocell(path, life, rule);
+
+    SparseWorld sparse;
+    sparse.set_rule(rule);
+    const Node *root = life.get_root();
+    std::function<void(const Node*, long long, long long)> visit = [&](const Node *node, long long x0, long long y0) {
+        if (node->population == 0) {
+            return;
+        }
+        if (node->level == 0) {
+            sparse.set(x0, y0, Cell::ALIVE);
+            return;
+        }
+        long long half = 1LL << (node->level - 1);
+        visit(node->nw, x0, y0);
+        visit(node->ne, x0 + half, y0);
+        visit(node->sw, x0, y0 + half);
+        visit(node->se, x0 + half, y0 + half);
+    };
+    long long half = 1LL << (root->level - 1);
+    visit(root, -half, -half);
+    return sparse;
+}
+
+/**
+ * Zoo::save_macrocell(path, life)
+ *
+ * Save a HashLife universe as a macrocell .mc file, see Zoo::load_macrocell(path, rule) for the format.
+ * Each distinct node is written once, children before their parents, so the file is as compact as the
+ * node cache. The rule of the universe is written to the "#R" line.
+ *
+ * @example
+ *
+ *      // Save a universe after a long run
+ *      life.advance(1 << 30);
+ *      Zoo::save_macrocell("path/to/file.mc", life);
  *
  * @param path
  *      The std::string path to the file to write to.
  *
- * @param grid
- *      The grid to be written out to file.
+ * @param life
+ *      The universe to be written out to file.
  *
  * @throws
  *      Throws std::runtime_error or sub-class if the file cannot be opened.
  */
-void Zoo::save_binary(std::string path, Grid grid) {
-    std::ofstream outputFile(path);
+void Zoo::save_macrocell(std::string path, const HashLife &life) {
+    typedef HashLife::Node Node;
+
+    std::ofstream outputFile(path, std::ios_base::binary);
     if (!outputFile.is_open()) {
         throw std::runtime_error("File cannot be opened");
     }
-    int width = grid.get_width();
-    int height = grid.get_height();
-    
-    outputFile.write((char*)&width, 4);
-    outputFile.write((char*)&height, 4);
-
-    int count = 0;
-    int padSize = grid.get_total_cells() + (grid.get_total_cells()%8);
-    std::bitset<8> byte;
-    for (int i = 0; i < padSize; i++) {
-        if (grid.grid[i] == Cell::ALIVE) {
-            byte[count] = 1;
+    std::string text = "[M2] (Game_of_Life)\n#R " + life.get_rule().to_string() + "\n";
+
+    // Reads cell (x, y) of a node
+    std::function<bool(const Node*, int, int)> cell = [&](const Node *node, int x, int y) {
+        while (node->level > 0 && node->population > 0) {
+            int half = 1 << (node->level - 1);
+            bool east = x >= half, south = y >= half;
+            node = south ? (east ? node->se : node->sw) : (east ? node->ne : node->nw);
+            x -= east ? half : 0;
+            y -= south ? half : 0;
+        }
+        return node->population > 0;
+    };
+
+    std::unordered_map<const Node*, long long> numbers;
+    long long count = 0;
+    std::function<long long(const Node*)> write = [&](const Node *node) -> long long {
+        if (node->population == 0) {
+            return 0;
+        }
+        auto found = numbers.find(node);
+        if (found != numbers.end()) {
+            return found->second;
+        }
+        if (node->level == 3) {
+            std::string rows;
+            for (int y = 0; y < 8; y++) {
+                std::string row;
+                for (int x = 0; x < 8; x++) {
+                    row += cell(node, x, y) ? '*' : '.';
+                }
+                row.erase(row.find_last_not_of('.') + 1);
+                rows += row + '$';
+            }
+            rows.erase(rows.find_last_not_of('$') + 2);
+            text += rows + '\n';
         } else {
-            byte[count] = 0;
-        }      
-        
-        count++;
-        if (count == 8) {
-            outputFile.write((char*)&byte,1);
-            count = 0;
+            long long nw = write(node->nw), ne = write(node->ne), sw = write(node->sw), se = write(node->se);
+            text += std::to_string(node->level) + ' ' + std::to_string(nw) + ' ' + std::to_string(ne) + ' '
+                  + std::to_string(sw) + ' ' + std::to_string(se) + '\n';
         }
-        
+        numbers[node] = ++count;
+        return count;
+    };
+
+    // An empty universe is written as a single empty 8x8 node
+    const Node *root = life.get_root();
+    if (root->population == 0) {
+        text += "$\n";
+    } else {
+        write(root);
     }
+    outputFile.write(text.data(), static_cast<std::streamsize>(text.size()));
+}
 
-    outputFile.close();
+/**
+ * Zoo::save_macrocell(path, grid, rule)
+ *
+ * Save a grid as a macrocell .mc file, with the top left of the grid at (0, 0) of the universe.
+ * See Zoo::save_macrocell(path, life).
+ *
+ * @param path
+ *      The std::string path to the file to write to.
+ *
+ * @param grid
+ *      The grid to be written out to file.
+ *
+ * @param rule
+ *      Optional parameter. The rule written to the file. Defaults to B3/S23.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if the file cannot be opened.
+ */
+void Zoo::save_macrocell(std::string path, const Grid &grid, const Rule &rule) {
+    HashLife life(grid);
+    life.set_rule(rule);
+    save_macrocell(path, life);
+}
+
+/**
+ * MAP_WINDOW
+ *
+ * The number of bytes of a binary file mapped into memory at a time while loading.
+ */
+static const std::size_t MAP_WINDOW = std::size_t(64) << 20;
+
+/**
+ * BINARY_HEADER
+ *
+ * The size in bytes of the width and height at the start of a binary file.
+ */
+static const std::uint64_t BINARY_HEADER = 2 * sizeof(int);
+
+/**
+ * read_binary_header(file, width, height)
+ *
+ * Reads and validates the width and height of a binary file, checking the file is long enough to hold every cell.
+ */
+static void read_binary_header(const MappedFile &file, int &width, int &height) {
+    MappedFile::Window header = file.map(0, BINARY_HEADER);
+    std::memcpy(&width, header.data(), sizeof(int));
+    std::memcpy(&height, header.data() + sizeof(int), sizeof(int));
+    if (width < 0 || height < 0) {
+        throw std::runtime_error("Malformed file");
+    }
+    const std::uint64_t cells = static_cast<std::uint64_t>(width) * height;
+    if ((cells + 7) / 8 > file.get_size() - BINARY_HEADER) {
+        throw std::runtime_error("File ends unexpectedly");
+    }
+}
+
+/**
+ * load_le64(bytes, available)
+ *
+ * Reads up to 8 bytes as a little endian word, the first byte holding bits 0 to 7.
+ * Bytes past the available count read as zero.
+ */
+static inline std::uint64_t load_le64(const unsigned char *bytes, std::size_t available) {
+    std::uint64_t word = 0;
+    const std::size_t count = std::min<std::size_t>(available, 8);
+    for (std::size_t i = 0; i < count; i++) {
+        word |= static_cast<std::uint64_t>(bytes[i]) << (8 * i);
+    }
+    return word;
+}
+
+/**
+ * SNAPSHOT_MAGIC, SNAPSHOT_VERSION, SNAPSHOT_BYTE_ORDER
+ *
+ * The first bytes of a v2 snapshot, followed by the format version and a marker of the byte order
+ * the header was written in. Every field of a snapshot is little endian, whatever the host.
+ */
+static const char SNAPSHOT_MAGIC[4] = {'B', 'G', 'O', 'L'};
+static const unsigned SNAPSHOT_VERSION = 2;
+static const unsigned SNAPSHOT_BYTE_ORDER = 0xFEFF;
+
+/**
+ * SNAPSHOT_HEADER, SNAPSHOT_ENTRY, SNAPSHOT_TILE
+ *
+ * The size in bytes of the snapshot header and of each tile index entry,
+ * and the width and height in cells of the tiles written by Zoo::save_snapshot.
+ */
+static const std::size_t SNAPSHOT_HEADER = 56;
+static const std::size_t SNAPSHOT_ENTRY = 20;
+static const int SNAPSHOT_TILE = 256;
+
+/**
+ * SnapshotHeader
+ *
+ * The fields of a v2 snapshot header, see Zoo::save_snapshot for the layout.
+ */
+struct SnapshotHeader {
+    int width;
+    int height;
+    int tile_size;
+    Zoo::Codec codec;
+    Rule rule;
+    long long generation;
+    std::uint32_t tile_count;
+    std::uint64_t index_offset;
+};
+
+/**
+ * put_le(out, value, bytes)
+ *
+ * Appends the lowest bytes of a value to a buffer, least significant byte first.
+ */
+static void put_le(std::vector<unsigned char> &out, std::uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out.push_back(static_cast<unsigned char>(value >> (8 * i)));
+    }
+}
+
+/**
+ * crc32(bytes, size)
+ *
+ * Computes the IEEE CRC-32 of a byte range, as used by zip and png.
+ */
+static std::uint32_t crc32(const unsigned char *bytes, std::size_t size) {
+    static const std::vector<std::uint32_t> table = [] {
+        std::vector<std::uint32_t> table(256);
+        for (std::uint32_t n = 0; n < 256; n++) {
+            std::uint32_t c = n;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            table[n] = c;
+        }
+        return table;
+    }();
+
+    std::uint32_t crc = 0xFFFFFFFFu;
+    for (std::size_t i = 0; i < size; i++) {
+        crc = table[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+/**
+ * put_varint(out, value), get_varint(bytes, end, value)
+ *
+ * Writes and reads an unsigned integer 7 bits per byte, lowest first, the top bit of each byte marking
+ * that another follows. Reading fails if the integer runs past the end of the bytes.
+ */
+static void put_varint(std::vector<unsigned char> &out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<unsigned char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<unsigned char>(value));
+}
+
+static bool get_varint(const unsigned char *&bytes, const unsigned char *end, std::uint64_t &value) {
+    value = 0;
+    for (int shift = 0; bytes < end && shift < 64; shift += 7) {
+        const unsigned char byte = *bytes++;
+        value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * compress_zero_runs(raw, size, out)
+ *
+ * The built in tile codec, Zoo::Codec::ZERO_RUNS. The tile is read as 8 byte words, written as pairs
+ * of a varint count of zero words and a varint count of the literal words that follow, which are copied as is.
+ * Dead space costs a byte or two however large it is, which is most of a typical board.
+ */
+static void compress_zero_runs(const unsigned char *raw, std::size_t size, std::vector<unsigned char> &out) {
+    static const unsigned char zero[8] = {};
+    const std::size_t words = size / 8;
+    std::size_t i = 0;
+    while (i < words) {
+        const std::size_t zeros_from = i;
+        while (i < words && std::memcmp(raw + 8 * i, zero, 8) == 0) {
+            i++;
+        }
+        const std::size_t literals_from = i;
+        while (i < words && std::memcmp(raw + 8 * i, zero, 8) != 0) {
+            i++;
+        }
+        put_varint(out, literals_from - zeros_from);
+        put_varint(out, i - literals_from);
+        out.insert(out.end(), raw + 8 * literals_from, raw + 8 * i);
+    }
+}
+
+/**
+ * expand_zero_runs(packed, size, raw, raw_size)
+ *
+ * Reverses compress_zero_runs(raw, size, out).
+ *
+ * @return
+ *      False if the compressed bytes are malformed or do not expand to exactly raw_size bytes.
+ */
+static bool expand_zero_runs(const unsigned char *packed, std::size_t size, unsigned char *raw, std::size_t raw_size) {
+    const unsigned char *end = packed + size;
+    const std::size_t words = raw_size / 8;
+    std::size_t i = 0;
+    while (packed < end) {
+        std::uint64_t zeros, literals;
+        if (!get_varint(packed, end, zeros) || !get_varint(packed, end, literals)
+                || zeros > words - i || literals > words - i - zeros
+                || literals * 8 > static_cast<std::uint64_t>(end - packed)) {
+            return false;
+        }
+        std::memset(raw + 8 * i, 0, static_cast<std::size_t>(zeros) * 8);
+        i += static_cast<std::size_t>(zeros);
+        std::memcpy(raw + 8 * i, packed, static_cast<std::size_t>(literals) * 8);
+        packed += literals * 8;
+        i += static_cast<std::size_t>(literals);
+    }
+    return i == words;
+}
+
+/**
+ * compress_tile(codec, raw, size, out)
+ *
+ * Compresses the bytes of a tile with the given codec, replacing the contents of out.
+ *
+ * @throws
+ *      std::runtime_error or sub-class if the codec was not compiled in.
+ */
+static void compress_tile(Zoo::Codec codec, const unsigned char *raw, std::size_t size, std::vector<unsigned char> &out) {
+    out.clear();
+    switch (codec) {
+        case Zoo::Codec::NONE:
+            out.assign(raw, raw + size);
+            return;
+        case Zoo::Codec::ZERO_RUNS:
+            compress_zero_runs(raw, size, out);
+            return;
+#ifdef GOL_HAVE_LZ4
+        case Zoo::Codec::LZ4: {
+            out.resize(static_cast<std::size_t>(LZ4_compressBound(static_cast<int>(size))));
+            const int written = LZ4_compress_default(reinterpret_cast<const char*>(raw), reinterpret_cast<char*>(out.data()),
+                                                     static_cast<int>(size), static_cast<int>(out.size()));
+            if (written <= 0) {
+                throw std::runtime_error("Tile cannot be compressed");
+            }
+            out.resize(static_cast<std::size_t>(written));
+            return;
+        }
+#endif
+#ifdef GOL_HAVE_ZSTD
+        case Zoo::Codec::ZSTD: {
+            out.resize(ZSTD_compressBound(size));
+            const std::size_t written = ZSTD_compress(out.data(), out.size(), raw, size, 3);
+            if (ZSTD_isError(written)) {
+                throw std::runtime_error("Tile cannot be compressed");
+            }
+            out.resize(written);
+            return;
+        }
+#endif
+        default:
+            throw std::runtime_error("Snapshot codec not supported by this build");
+    }
+}
+
+/**
+ * expand_tile(codec, packed, size, raw, raw_size)
+ *
+ * Decompresses a tile written by compress_tile(codec, raw, size, out) into exactly raw_size bytes.
+ *
+ * @throws
+ *      std::runtime_error or sub-class if:
+ *          - The codec was not compiled in.
+ *          - The compressed bytes are malformed.
+ */
+static void expand_tile(Zoo::Codec codec, const unsigned char *packed, std::size_t size,
+                        unsigned char *raw, std::size_t raw_size) {
+    bool expanded = false;
+    switch (codec) {
+        case Zoo::Codec::NONE:
+            expanded = (size == raw_size);
+            if (expanded) {
+                std::memcpy(raw, packed, size);
+            }
+            break;
+        case Zoo::Codec::ZERO_RUNS:
+            expanded = expand_zero_runs(packed, size, raw, raw_size);
+            break;
+#ifdef GOL_HAVE_LZ4
+        case Zoo::Codec::LZ4:
+            expanded = size <= INT_MAX && LZ4_decompress_safe(reinterpret_cast<const char*>(packed), reinterpret_cast<char*>(raw),
+                                                              static_cast<int>(size), static_cast<int>(raw_size))
+                                          == static_cast<int>(raw_size);
+            break;
+#endif
+#ifdef GOL_HAVE_ZSTD
+        case Zoo::Codec::ZSTD:
+            expanded = ZSTD_decompress(raw, raw_size, packed, size) == raw_size;
+            break;
+#endif
+        default:
+            throw std::runtime_error("Snapshot codec not supported by this build");
+    }
+    if (!expanded) {
+        throw std::runtime_error("Malformed file");
+    }
+}
+
+/**
+ * is_snapshot(file)
+ *
+ * Tests whether a binary file is a v2 snapshot rather than a v1 bit stream, by its leading magic bytes.
+ *
+ * @throws
+ *      std::runtime_error or sub-class if the file is a snapshot of a version this build cannot read.
+ */
+static bool is_snapshot(const MappedFile &file) {
+    if (file.get_size() < sizeof(SNAPSHOT_MAGIC) + 2) {
+        return false;
+    }
+    MappedFile::Window start = file.map(0, sizeof(SNAPSHOT_MAGIC) + 2);
+    if (std::memcmp(start.data(), SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) {
+        return false;
+    }
+    if (load_le64(start.data() + sizeof(SNAPSHOT_MAGIC), 2) != SNAPSHOT_VERSION) {
+        throw std::runtime_error("Unsupported snapshot version");
+    }
+    return true;
+}
+
+/**
+ * read_snapshot_header(file)
+ *
+ * Reads and validates the header of a v2 snapshot.
+ *
+ * @throws
+ *      std::runtime_error or sub-class if the header is malformed or fails its checksum.
+ */
+static SnapshotHeader read_snapshot_header(const MappedFile &file) {
+    if (file.get_size() < SNAPSHOT_HEADER) {
+        throw std::runtime_error("File ends unexpectedly");
+    }
+    MappedFile::Window window = file.map(0, SNAPSHOT_HEADER);
+    const unsigned char *data = window.data();
+    if (crc32(data, 48) != load_le64(data + 48, 4)) {
+        throw std::runtime_error("Snapshot header checksum mismatch");
+    }
+    if (load_le64(data + 6, 2) != SNAPSHOT_BYTE_ORDER) {
+        throw std::runtime_error("Malformed file");
+    }
+
+    const std::uint64_t width = load_le64(data + 8, 4);
+    const std::uint64_t height = load_le64(data + 12, 4);
+    const std::uint64_t tile_size = load_le64(data + 16, 4);
+    const unsigned codec = data[20];
+    if (width > INT_MAX || height > INT_MAX || tile_size == 0 || tile_size % 64 != 0 || tile_size > 4096
+            || codec > static_cast<unsigned>(Zoo::Codec::ZSTD)) {
+        throw std::runtime_error("Malformed file");
+    }
+
+    SnapshotHeader header;
+    header.width = static_cast<int>(width);
+    header.height = static_cast<int>(height);
+    header.tile_size = static_cast<int>(tile_size);
+    header.codec = static_cast<Zoo::Codec>(codec);
+    header.rule = Rule(static_cast<unsigned>(load_le64(data + 24, 2)), static_cast<unsigned>(load_le64(data + 26, 2)));
+    header.tile_count = static_cast<std::uint32_t>(load_le64(data + 28, 4));
+    header.generation = static_cast<long long>(load_le64(data + 32, 8));
+    header.index_offset = load_le64(data + 40, 8);
+    if (header.index_offset < SNAPSHOT_HEADER || header.index_offset > file.get_size()
+            || (header.tile_count * std::uint64_t(SNAPSHOT_ENTRY) + 4) > file.get_size() - header.index_offset) {
+        throw std::runtime_error("File ends unexpectedly");
+    }
+    return header;
+}
+
+/**
+ * read_snapshot_tiles(file, header, wanted, visit)
+ *
+ * Decompresses the tiles listed in the index of a v2 snapshot for which wanted(tx, ty) is true, or every tile
+ * if wanted is empty, checking each against its checksum, and passes its words to visit(tx, ty, words).
+ * A tile holds tile_size rows of tile_size / 64 words, cell x of the tile being bit (x % 64) of word (x / 64)
+ * of its row. Tiles not in the index are all dead. Only the tiles wanted are read from the file.
+ *
+ * @throws
+ *      std::runtime_error or sub-class if the index or a tile is malformed or fails its checksum.
+ */
+static void read_snapshot_tiles(const MappedFile &file, const SnapshotHeader &header,
+                                const std::function<bool(int, int)> &wanted,
+                                const std::function<void(int, int, const std::uint64_t*)> &visit) {
+    const std::uint64_t tiles_x = (static_cast<std::uint64_t>(header.width) + header.tile_size - 1) / header.tile_size;
+    const std::uint64_t tiles_y = (static_cast<std::uint64_t>(header.height) + header.tile_size - 1) / header.tile_size;
+    const std::size_t index_size = static_cast<std::size_t>(header.tile_count) * SNAPSHOT_ENTRY;
+    MappedFile::Window index = file.map(header.index_offset, index_size + 4);
+    if (crc32(index.data(), index_size) != load_le64(index.data() + index_size, 4)) {
+        throw std::runtime_error("Snapshot index checksum mismatch");
+    }
+
+    const std::size_t raw_size = static_cast<std::size_t>(header.tile_size) * header.tile_size / 8;
+    std::vector<unsigned char> raw(raw_size);
+    std::vector<std::uint64_t> words(raw_size / 8);
+    for (std::uint32_t t = 0; t < header.tile_count; t++) {
+        const unsigned char *entry = index.data() + static_cast<std::size_t>(t) * SNAPSHOT_ENTRY;
+        const std::uint64_t number = load_le64(entry, 4);
+        const std::uint64_t size = load_le64(entry + 4, 4);
+        const std::uint64_t offset = load_le64(entry + 8, 8);
+        if (number >= tiles_x * tiles_y || offset < SNAPSHOT_HEADER || offset > header.index_offset
+                || size > header.index_offset - offset) {
+            throw std::runtime_error("Malformed file");
+        }
+
+        const int tx = static_cast<int>(number % tiles_x);
+        const int ty = static_cast<int>(number / tiles_x);
+        if (wanted && !wanted(tx, ty)) {
+            continue;
+        }
+
+        MappedFile::Window tile = file.map(offset, static_cast<std::size_t>(size),
+                                           wanted ? MappedFile::Access::RANDOM : MappedFile::Access::SEQUENTIAL);
+        expand_tile(header.codec, tile.data(), tile.get_size(), raw.data(), raw_size);
+        if (crc32(raw.data(), raw_size) != load_le64(entry + 16, 4)) {
+            throw std::runtime_error("Snapshot tile checksum mismatch");
+        }
+        for (std::size_t i = 0; i < words.size(); i++) {
+            words[i] = load_le64(raw.data() + 8 * i, 8);
+        }
+        visit(tx, ty, words.data());
+    }
+}
+
+/**
+ * load_snapshot(file, header)
+ *
+ * Loads the cells of a v2 snapshot into a bit grid.
+ */
+static BitGrid load_snapshot(const MappedFile &file, const SnapshotHeader &header) {
+    BitGrid bits(header.width, header.height);
+    const int words = bits.get_words_per_row();
+    const std::uint64_t tail_mask = bits.get_tail_mask();
+    const int tile_words = header.tile_size / 64;
+    read_snapshot_tiles(file, header, nullptr, [&](int tx, int ty, const std::uint64_t *tile) {
+        const int first = tx * tile_words;
+        const int count = std::min(tile_words, words - first);
+        const int rows = std::min(header.tile_size, header.height - ty * header.tile_size);
+        for (int r = 0; r < rows; r++) {
+            std::uint64_t *row = bits.row(ty * header.tile_size + r);
+            for (int j = 0; j < count; j++) {
+                const std::uint64_t word = tile[static_cast<std::size_t>(r) * tile_words + j];
+                row[first + j] = (first + j == words - 1) ? word & tail_mask : word;
+            }
+        }
+    });
+    return bits;
+}
+
+/**
+ * Zoo::load_binary(path)
+ *
+ * Load a binary file and parse it as a grid of cells. See Zoo::load_binary(path, rule, generation).
+ *
+ * @example
+ *
+ *      // Load an binary file from a directory
+ *      Grid grid = Zoo::load_binary("path/to/file.bgol");
+ *
+ * @param path
+ *      The std::string path to the file to read in.
+ *
+ * @return
+ *      Returns the parsed grid.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if:
+ *          - The file cannot be opened.
+ *          - The file ends unexpectedly.
+ *          - The file is a snapshot that is malformed or fails a checksum.
+ */
+Grid Zoo::load_binary(std::string path) {
+    Rule rule;
+    long long generation;
+    return load_binary(path, rule, generation);
+}
+
+/**
+ * Zoo::load_binary(path, rule, generation)
+ *
+ * Load a binary file and parse it as a grid of cells, along with the rule and generation of a v2 snapshot.
+ * Both versions of the format are read, told apart by the magic bytes of a snapshot, see Zoo::save_snapshot.
+ * A v1 file records no rule or generation, so they are set to B3/S23 and 0.
+ *
+ * A v1 file is read through memory mapped windows of MAP_WINDOW bytes, see mapped_file.cpp, so the pages
+ * are read straight from the page cache without a copy, and a file far larger than memory never has
+ * more than one window resident. Each byte is unpacked into its 8 cells with a single table lookup.
+ *
+ * @example
+ *
+ *      // Resume a saved simulation with its rule
+ *      Rule rule;
+ *      long long generation;
+ *      World world(Zoo::load_binary("path/to/file.bgol", rule, generation));
+ *      world.set_rule(rule);
+ *
+ * @param path
+ *      The std::string path to the file to read in.
+ *
+ * @param rule
+ *      Set to the rule stored in the file.
+ *
+ * @param generation
+ *      Set to the generation stored in the file.
+ *
+ * @return
+ *      Returns the parsed grid.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if:
+ *          - The file cannot be opened.
+ *          - The file ends unexpectedly.
+ *          - The file is a snapshot that is malformed or fails a checksum.
+ */
+Grid Zoo::load_binary(std::string path, Rule &rule, long long &generation) {
+    MappedFile file(path);
+    if (is_snapshot(file)) {
+        const SnapshotHeader header = read_snapshot_header(file);
+        rule = header.rule;
+        generation = header.generation;
+        return load_snapshot(file, header).to_grid();
+    }
+    rule = Rule();
+    generation = 0;
+
+    int width, height;
+    read_binary_header(file, width, height);
+
+    // Every byte value spelled out as 8 cells, bit 0 first
+    static const std::vector<std::uint64_t> spread = [] {
+        std::vector<std::uint64_t> table(256);
+        for (int byte = 0; byte < 256; byte++) {
+            Cell cells[8];
+            for (int bit = 0; bit < 8; bit++) {
+                cells[bit] = ((byte >> bit) & 1) ? Cell::ALIVE : Cell::DEAD;
+            }
+            std::memcpy(&table[byte], cells, sizeof(cells));
+        }
+        return table;
+    }();
+
+    Grid grid(width, height);
+    const std::size_t cells = grid.grid.size();
+    const std::uint64_t bytes = (cells + 7) / 8;
+    Cell *out = grid.grid.data();
+    for (std::uint64_t offset = 0; offset < bytes; offset += MAP_WINDOW) {
+        MappedFile::Window window = file.map(BINARY_HEADER + offset,
+                                             static_cast<std::size_t>(std::min<std::uint64_t>(MAP_WINDOW, bytes - offset)));
+        const unsigned char *data = window.data();
+        for (std::size_t i = 0; i < window.get_size(); i++) {
+            const std::size_t cell = static_cast<std::size_t>(offset + i) * 8;
+            std::memcpy(out + cell, &spread[data[i]], std::min<std::size_t>(8, cells - cell));
+        }
+    }
+    return grid;
+}
+
+/**
+ * Zoo::load_binary_packed(path)
+ *
+ * Load a binary file straight into bit-packed storage. See Zoo::load_binary_packed(path, rule, generation).
+ *
+ * @example
+ *
+ *      // Load a large snapshot to step with Engine::PACKED
+ *      BitGrid bits = Zoo::load_binary_packed("path/to/file.bgol");
+ *
+ * @param path
+ *      The std::string path to the file to read in.
+ *
+ * @return
+ *      Returns the parsed grid.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if:
+ *          - The file cannot be opened.
+ *          - The file ends unexpectedly.
+ *          - The file is a snapshot that is malformed or fails a checksum.
+ */
+BitGrid Zoo::load_binary_packed(std::string path) {
+    Rule rule;
+    long long generation;
+    return load_binary_packed(path, rule, generation);
+}
+
+/**
+ * Zoo::load_binary_packed(path, rule, generation)
+ *
+ * Load a binary file straight into bit-packed storage, without going through a byte per cell,
+ * along with the rule and generation of a v2 snapshot as in Zoo::load_binary(path, rule, generation).
+ * Snapshots may be larger than a Grid can hold, up to INT_MAX cells wide and high.
+ *
+ * The tiles of a snapshot are copied into the rows a word at a time. The bits of a v1 file run on
+ * from one row to the next, while each BitGrid row starts on a fresh word, so every row is realigned
+ * as it is copied a word at a time. When the width is a multiple of 64 no shifting is needed.
+ * The file is streamed through memory mapped windows as in Zoo::load_binary(path, rule, generation).
+ *
+ * @example
+ *
+ *      // Resume a large simulation with Engine::PACKED
+ *      Rule rule;
+ *      long long generation;
+ *      BitGrid bits = Zoo::load_binary_packed("path/to/file.bgol", rule, generation);
+ *
+ * @param path
+ *      The std::string path to the file to read in.
+ *
+ * @param rule
+ *      Set to the rule stored in the file.
+ *
+ * @param generation
+ *      Set to the generation stored in the file.
+ *
+ * @return
+ *      Returns the parsed grid.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if:
+ *          - The file cannot be opened.
+ *          - The file ends unexpectedly.
+ *          - The file is a snapshot that is malformed or fails a checksum.
+ */
+BitGrid Zoo::load_binary_packed(std::string path, Rule &rule, long long &generation) {
+    MappedFile file(path);
+    if (is_snapshot(file)) {
+        const SnapshotHeader header = read_snapshot_header(file);
+        rule = header.rule;
+        generation = header.generation;
+        return load_snapshot(file, header);
+    }
+    rule = Rule();
+    generation = 0;
+
+    int width, height;
+    read_binary_header(file, width, height);
+
+    BitGrid bits(width, height);
+    if (width == 0) {
+        return bits;
+    }
+    const int words = bits.get_words_per_row();
+    const std::uint64_t tail_mask = bits.get_tail_mask();
+    const int rows_per_window = static_cast<int>(std::max<std::uint64_t>(1, MAP_WINDOW * 8 / width));
+
+    for (int y0 = 0; y0 < height; y0 += rows_per_window) {
+        const int y1 = std::min(height, y0 + rows_per_window);
+        const std::uint64_t first = static_cast<std::uint64_t>(y0) * width / 8;
+        const std::uint64_t last = (static_cast<std::uint64_t>(y1) * width + 7) / 8;
+        MappedFile::Window window = file.map(BINARY_HEADER + first, static_cast<std::size_t>(last - first));
+        const unsigned char *data = window.data();
+
+        for (int y = y0; y < y1; y++) {
+            std::uint64_t *row = bits.row(y);
+            const std::uint64_t start = static_cast<std::uint64_t>(y) * width - first * 8;
+            for (int i = 0; i < words; i++) {
+                const std::uint64_t bit = start + static_cast<std::uint64_t>(i) * 64;
+                const std::size_t byte = static_cast<std::size_t>(bit / 8);
+                const int shift = static_cast<int>(bit % 8);
+                std::uint64_t word = load_le64(data + byte, window.get_size() - byte) >> shift;
+                if (shift && byte + 8 < window.get_size()) {
+                    word |= static_cast<std::uint64_t>(data[byte + 8]) << (64 - shift);
+                }
+                row[i] = (i == words - 1) ? word & tail_mask : word;
+            }
+        }
+    }
+    return bits;
+}
+
+/**
+ * Zoo::load_region(path, x0, y0, x1, y1)
+ *
+ * Load a rectangle of cells from a binary file, without reading the rest of the file.
+ * The region spans the range [x0, x1) by [y0, y1) of the saved grid, as with Grid::crop.
+ *
+ * A v2 snapshot is read through its tile index, so only the tiles overlapping the region are read
+ * and decompressed. The rows of a v1 file are found by their position in the bit stream, and only the bytes
+ * of each row within the region are touched. Either way the cost follows the size of the region
+ * rather than of the file, which makes a window onto a huge board cheap to inspect.
+ *
+ * @example
+ *
+ *      // Look at the 100x100 cells around the centre of a 64k x 64k board
+ *      Grid region = Zoo::load_region("path/to/file.bgol", 32718, 32718, 32818, 32818);
+ *
+ * @param path
+ *      The std::string path to the file to read in.
+ *
+ * @param x0
+ *      Left coordinate of the region on x-axis.
+ *
+ * @param y0
+ *      Top coordinate of the region on y-axis.
+ *
+ * @param x1
+ *      Right coordinate of the region on x-axis (1 greater than the largest index).
+ *
+ * @param y1
+ *      Bottom coordinate of the region on y-axis (1 greater than the largest index).
+ *
+ * @return
+ *      A grid of the size of the region holding the cells within it.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if:
+ *          - The file cannot be opened.
+ *          - The file ends unexpectedly.
+ *          - The file is a snapshot that is malformed or fails a checksum.
+ *          - The region does not lie within the saved grid, or has a negative size.
+ */
+Grid Zoo::load_region(std::string path, int x0, int y0, int x1, int y1) {
+    MappedFile file(path);
+    const bool snapshot = is_snapshot(file);
+    SnapshotHeader header;
+    int width, height;
+    if (snapshot) {
+        header = read_snapshot_header(file);
+        width = header.width;
+        height = header.height;
+    } else {
+        read_binary_header(file, width, height);
+    }
+    if (x0 < 0 || y0 < 0 || x1 < x0 || y1 < y0 || x1 > width || y1 > height) {
+        throw std::runtime_error("Region out of bounds");
+    }
+    const int region_width = x1 - x0;
+    const int region_height = y1 - y0;
+    if (static_cast<std::uint64_t>(region_width) * static_cast<std::uint64_t>(region_height) > INT_MAX) {
+        throw std::runtime_error("Region too large");
+    }
+
+    Grid region(region_width, region_height);
+    Cell *out = region.grid.data();
+    if (snapshot) {
+        const std::int64_t size = header.tile_size;
+        const int tile_words = header.tile_size / 64;
+        read_snapshot_tiles(file, header,
+            [&](int tx, int ty) {
+                return tx * size < x1 && (tx + 1) * size > x0 && ty * size < y1 && (ty + 1) * size > y0;
+            },
+            [&](int tx, int ty, const std::uint64_t *tile) {
+                const int left = static_cast<int>(std::max<std::int64_t>(x0, tx * size));
+                const int right = static_cast<int>(std::min<std::int64_t>(x1, (tx + 1) * size));
+                const int top = static_cast<int>(std::max<std::int64_t>(y0, ty * size));
+                const int bottom = static_cast<int>(std::min<std::int64_t>(y1, (ty + 1) * size));
+                for (int y = top; y < bottom; y++) {
+                    const std::uint64_t *row = tile + static_cast<std::size_t>(y - ty * size) * tile_words;
+                    Cell *cells = out + static_cast<std::size_t>(y - y0) * region_width;
+                    for (int x = left; x < right; x++) {
+                        const int bit = static_cast<int>(x - tx * size);
+                        if ((row[bit / 64] >> (bit % 64)) & 1) {
+                            cells[x - x0] = Cell::ALIVE;
+                        }
+                    }
+                }
+            });
+        return region;
+    }
+
+    if (region_width == 0 || region_height == 0) {
+        return region;
+    }
+    // Each window spans whole rows, but is advised as random so only the pages within the region are read
+    const int rows_per_window = static_cast<int>(std::max<std::uint64_t>(1, MAP_WINDOW * 8 / width));
+    for (int top = y0; top < y1; top += rows_per_window) {
+        const int bottom = std::min(y1, top + rows_per_window);
+        const std::uint64_t first = (static_cast<std::uint64_t>(top) * width + x0) / 8;
+        const std::uint64_t last = (static_cast<std::uint64_t>(bottom - 1) * width + x1 + 7) / 8;
+        MappedFile::Window window = file.map(BINARY_HEADER + first, static_cast<std::size_t>(last - first),
+                                             MappedFile::Access::RANDOM);
+        const unsigned char *data = window.data();
+        for (int y = top; y < bottom; y++) {
+            Cell *cells = out + static_cast<std::size_t>(y - y0) * region_width;
+            const std::uint64_t start = static_cast<std::uint64_t>(y) * width + x0 - first * 8;
+            for (int i = 0; i < region_width; i++) {
+                const std::uint64_t bit = start + i;
+                if ((data[bit / 8] >> (bit % 8)) & 1) {
+                    cells[i] = Cell::ALIVE;
+                }
+            }
+        }
+    }
+    return region;
+}
+
+/**
+ * BinaryWriter
+ *
+ * Appends runs of bits to a binary file, lowest bit first, collecting them in a large buffer so that
+ * the file is written in a few big chunks.
+ */
+class BinaryWriter {
+private:
+    std::ofstream &file;
+    std::vector<unsigned char> buffer;
+    std::size_t used;
+    std::uint64_t pending;
+    int pending_bits;
+
+    void emit(std::uint64_t word, int bytes) {
+        if (used + 8 > buffer.size()) {
+            flush();
+        }
+        for (int i = 0; i < bytes; i++) {
+            buffer[used++] = static_cast<unsigned char>(word >> (8 * i));
+        }
+    }
+
+    void flush() {
+        file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(used));
+        used = 0;
+    }
+
+public:
+    static const std::size_t CHUNK = std::size_t(1) << 20;
+
+    explicit BinaryWriter(std::ofstream &file) : file(file), buffer(CHUNK), used(0), pending(0), pending_bits(0) {
+    }
+
+    // Appends the lowest count bits of word, count being from 0 to 64
+    void put(std::uint64_t word, int count) {
+        if (count == 0) {
+            return;
+        }
+        if (count < 64) {
+            word &= (std::uint64_t(1) << count) - 1;
+        }
+        pending |= word << pending_bits;
+        if (pending_bits + count < 64) {
+            pending_bits += count;
+            return;
+        }
+        emit(pending, 8);
+        pending = pending_bits ? word >> (64 - pending_bits) : 0;
+        pending_bits += count - 64;
+    }
+
+    // Writes out the remaining bits, padding the final byte with 0 bits
+    void finish() {
+        emit(pending, (pending_bits + 7) / 8);
+        pending = 0;
+        pending_bits = 0;
+        flush();
+    }
+};
+
+/**
+ * pack_cells(cells)
+ *
+ * Packs 8 cells into a byte, the first cell in the lowest bit.
+ * Cell::ALIVE and Cell::DEAD differ in their lowest bit, so that bit of each cell byte is gathered
+ * into the top byte of the product by a single multiply.
+ */
+static inline std::uint64_t pack_cells(const Cell *cells) {
+    static_assert(((Cell::ALIVE ^ Cell::DEAD) & 1) != 0, "Cells must differ in their lowest bit");
+    std::uint64_t word;
+    std::memcpy(&word, cells, sizeof(word));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    word = __builtin_bswap64(word);
+#endif
+    word ^= 0x0101010101010101ull * static_cast<unsigned char>(Cell::DEAD);
+    return ((word & 0x0101010101010101ull) * 0x0102040810204080ull) >> 56;
+}
+
+/**
+ * Zoo::save_binary(path, grid)
+ *
+ * Save a grid as an binary .bgol file according to the specified file format.
+ *
+ * The grid is read in place, 64 cells at a time packed into a word with pack_cells(cells),
+ * and written out in chunks of 1 MiB. Only the bytes holding cells are written, the last one padded with 0 bits.
+ *
+ * @example
+ *
+ *      // Make an 8x8 grid
+ *      Grid grid(8);
+ *
+ *      // Save a grid to an binary file in a directory
+ *      try {
+ *          Zoo::save_binary("path/to/file.bgol", grid);
+ *      }
+ *      catch (const std::exception &ex) {
+ *          std::cerr << ex.what() << std::endl;
+ *      }
+ *
+ * @param path
+ *      The std::string path to the file to write to.
+ *
+ * @param grid
+ *      The grid to be written out to file.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if:
+ *          - The file cannot be opened.
+ *          - The file cannot be written.
+ */
+void Zoo::save_binary(std::string path, const Grid &grid) {
+    std::ofstream outputFile(path, std::ios_base::binary);
+    if (!outputFile.is_open()) {
+        throw std::runtime_error("File cannot be opened");
+    }
+    int width = grid.get_width();
+    int height = grid.get_height();
+    outputFile.write(reinterpret_cast<const char*>(&width), sizeof(int));
+    outputFile.write(reinterpret_cast<const char*>(&height), sizeof(int));
+
+    BinaryWriter writer(outputFile);
+    const Cell *cells = grid.grid.data();
+    const std::size_t total = grid.grid.size();
+    std::size_t i = 0;
+    for (; i + 64 <= total; i += 64) {
+        std::uint64_t word = 0;
+        for (int b = 0; b < 8; b++) {
+            word |= pack_cells(cells + i + 8 * b) << (8 * b);
+        }
+        writer.put(word, 64);
+    }
+    for (; i < total; i++) {
+        writer.put(cells[i] == Cell::ALIVE ? 1 : 0, 1);
+    }
+    writer.finish();
+
+    if (!outputFile) {
+        throw std::runtime_error("File cannot be written");
+    }
+}
+
+/**
+ * Zoo::save_binary(path, bits)
+ *
+ * Save a bit-packed grid as an binary .bgol file, in the same format as Zoo::save_binary(path, grid).
+ * Each row of the BitGrid is appended a word at a time, shifted to run on from the end of the previous row.
+ *
+ * @example
+ *
+ *      // Save the state of a large packed simulation
+ *      Zoo::save_binary("path/to/file.bgol", bits);
+ *
+ * @param path
+ *      The std::string path to the file to write to.
+ *
+ * @param bits
+ *      The grid to be written out to file.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if:
+ *          - The file cannot be opened.
+ *          - The file cannot be written.
+ */
+void Zoo::save_binary(std::string path, const BitGrid &bits) {
+    std::ofstream outputFile(path, std::ios_base::binary);
+    if (!outputFile.is_open()) {
+        throw std::runtime_error("File cannot be opened");
+    }
+    int width = bits.get_width();
+    int height = bits.get_height();
+    outputFile.write(reinterpret_cast<const char*>(&width), sizeof(int));
+    outputFile.write(reinterpret_cast<const char*>(&height), sizeof(int));
+
+    BinaryWriter writer(outputFile);
+    const int words = bits.get_words_per_row();
+    for (int y = 0; y < height; y++) {
+        const std::uint64_t *row = bits.row(y);
+        for (int i = 0; i < words; i++) {
+            writer.put(row[i], std::min(64, width - 64 * i));
+        }
+    }
+    writer.finish();
+
+    if (!outputFile) {
+        throw std::runtime_error("File cannot be written");
+    }
+}
+
+/**
+ * Zoo::save_snapshot(path, bits, rule, generation, codec)
+ *
+ * Save a bit-packed grid as a v2 binary .bgol snapshot, read back by Zoo::load_binary and Zoo::load_binary_packed.
+ *
+ * The grid is cut into tiles of 256x256 cells, and each tile holding an alive cell is compressed on its own
+ * and checksummed. Dead tiles are not written at all, so a mostly dead board takes a small fraction
+ * of the width * height / 8 bytes of a v1 file, and a tile can be read without reading the rest of the file.
+ *
+ * Snapshots are composed of, every integer being little endian:
+ *      - a 56 byte header:
+ *          - the 4 bytes "BGOL", a 2 byte version of 2, and a 2 byte byte order marker of 0xFEFF.
+ *          - a 4 byte width, 4 byte height and 4 byte tile size in cells.
+ *          - a 1 byte Zoo::Codec, then 3 reserved bytes.
+ *          - the 2 byte birth and 2 byte survival masks of the rule, see Rule.
+ *          - a 4 byte count of the tiles written, an 8 byte generation, and the 8 byte offset of the tile index.
+ *          - the 4 byte CRC-32 of the header so far, then 4 reserved bytes.
+ *      - the compressed tiles, each one uncompressed holding (tile size) rows of (tile size / 64) 8 byte words,
+ *        cell x of a row in bit (x % 64) of word (x / 64), padded with dead cells past the edges of the grid.
+ *      - the tile index, a 20 byte entry per tile:
+ *          - the 4 byte tile number (tile y * tiles per row + tile x), and 4 byte compressed size.
+ *          - the 8 byte offset of the compressed tile, and the 4 byte CRC-32 of the uncompressed tile.
+ *      - the 4 byte CRC-32 of the tile index.
+ *
+ * Zoo::Codec::NONE and Zoo::Codec::ZERO_RUNS are always available. Zoo::Codec::LZ4 and Zoo::Codec::ZSTD are built in
+ * when compiled with -DGOL_HAVE_LZ4 -llz4 or -DGOL_HAVE_ZSTD -lzstd, and a snapshot using either can only be loaded
+ * by a build that has it.
+ *
+ * @example
+ *
+ *      // Save the state of a large packed simulation with its rule and generation
+ *      Zoo::save_snapshot("path/to/file.bgol", bits, world.get_rule(), world.get_generation());
+ *
+ * @param path
+ *      The std::string path to the file to write to.
+ *
+ * @param bits
+ *      The grid to be written out to file.
+ *
+ * @param rule
+ *      Optional parameter. The rule written to the file. Defaults to B3/S23.
+ *
+ * @param generation
+ *      Optional parameter. The generation written to the file. Defaults to 0.
+ *
+ * @param codec
+ *      Optional parameter. The compression applied to each tile. Defaults to Zoo::Codec::ZERO_RUNS.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if:
+ *          - The codec was not compiled in.
+ *          - The file cannot be opened.
+ *          - The file cannot be written.
+ */
+void Zoo::save_snapshot(std::string path, const BitGrid &bits, const Rule &rule, long long generation, Codec codec) {
+    std::ofstream outputFile(path, std::ios_base::binary);
+    if (!outputFile.is_open()) {
+        throw std::runtime_error("File cannot be opened");
+    }
+    // Room for the header, written once the tiles are known
+    const std::vector<unsigned char> blank(SNAPSHOT_HEADER, 0);
+    outputFile.write(reinterpret_cast<const char*>(blank.data()), static_cast<std::streamsize>(blank.size()));
+
+    const int width = bits.get_width();
+    const int height = bits.get_height();
+    const int words = bits.get_words_per_row();
+    const int tile_words = SNAPSHOT_TILE / 64;
+    const int tiles_x = (width + SNAPSHOT_TILE - 1) / SNAPSHOT_TILE;
+    const int tiles_y = (height + SNAPSHOT_TILE - 1) / SNAPSHOT_TILE;
+
+    std::vector<unsigned char> raw(static_cast<std::size_t>(SNAPSHOT_TILE) * SNAPSHOT_TILE / 8);
+    std::vector<unsigned char> packed;
+    std::vector<unsigned char> index;
+    std::uint64_t offset = SNAPSHOT_HEADER;
+    std::uint32_t tile_count = 0;
+    for (int ty = 0; ty < tiles_y; ty++) {
+        for (int tx = 0; tx < tiles_x; tx++) {
+            // Skip dead tiles before gathering the rest as little endian words
+            const int first = tx * tile_words;
+            const int count = std::min(tile_words, words - first);
+            const int rows = std::min(SNAPSHOT_TILE, height - ty * SNAPSHOT_TILE);
+            std::uint64_t alive = 0;
+            for (int r = 0; r < rows && !alive; r++) {
+                const std::uint64_t *row = bits.row(ty * SNAPSHOT_TILE + r) + first;
+                for (int j = 0; j < count; j++) {
+                    alive |= row[j];
+                }
+            }
+            if (!alive) {
+                continue;
+            }
+            std::fill(raw.begin(), raw.end(), 0);
+            for (int r = 0; r < rows; r++) {
+                const std::uint64_t *row = bits.row(ty * SNAPSHOT_TILE + r) + first;
+                unsigned char *out = raw.data() + static_cast<std::size_t>(r) * tile_words * 8;
+                for (int j = 0; j < count; j++) {
+                    for (int b = 0; b < 8; b++) {
+                        out[8 * j + b] = static_cast<unsigned char>(row[j] >> (8 * b));
+                    }
+                }
+            }
+
+            compress_tile(codec, raw.data(), raw.size(), packed);
+            outputFile.write(reinterpret_cast<const char*>(packed.data()), static_cast<std::streamsize>(packed.size()));
+            put_le(index, static_cast<std::uint64_t>(ty) * tiles_x + tx, 4);
+            put_le(index, packed.size(), 4);
+            put_le(index, offset, 8);
+            put_le(index, crc32(raw.data(), raw.size()), 4);
+            offset += packed.size();
+            tile_count++;
+        }
+    }
+    put_le(index, crc32(index.data(), index.size()), 4);
+    outputFile.write(reinterpret_cast<const char*>(index.data()), static_cast<std::streamsize>(index.size()));
+
+    std::vector<unsigned char> header(SNAPSHOT_MAGIC, SNAPSHOT_MAGIC + sizeof(SNAPSHOT_MAGIC));
+    put_le(header, SNAPSHOT_VERSION, 2);
+    put_le(header, SNAPSHOT_BYTE_ORDER, 2);
+    put_le(header, static_cast<std::uint64_t>(width), 4);
+    put_le(header, static_cast<std::uint64_t>(height), 4);
+    put_le(header, SNAPSHOT_TILE, 4);
+    put_le(header, static_cast<std::uint64_t>(codec), 1);
+    put_le(header, 0, 3);
+    put_le(header, rule.get_birth(), 2);
+    put_le(header, rule.get_survival(), 2);
+    put_le(header, tile_count, 4);
+    put_le(header, static_cast<std::uint64_t>(generation), 8);
+    put_le(header, offset, 8);
+    put_le(header, crc32(header.data(), header.size()), 4);
+    put_le(header, 0, 4);
+    outputFile.seekp(0);
+    outputFile.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+
+    if (!outputFile) {
+        throw std::runtime_error("File cannot be written");
+    }
+}
+
+/**
+ * Zoo::save_snapshot(path, grid, rule, generation, codec)
+ *
+ * Save a grid as a v2 binary .bgol snapshot. See Zoo::save_snapshot(path, bits, rule, generation, codec).
+ *
+ * @example
+ *
+ *      // Save a world with its rule and generation
+ *      Zoo::save_snapshot("path/to/file.bgol", world.get_state(), world.get_rule(), world.get_generation());
+ *
+ * @param path
+ *      The std::string path to the file to write to.
+ *
+ * @param grid
+ *      The grid to be written out to file.
+ *
+ * @param rule
+ *      Optional parameter. The rule written to the file. Defaults to B3/S23.
+ *
+ * @param generation
+ *      Optional parameter. The generation written to the file. Defaults to 0.
+ *
+ * @param codec
+ *      Optional parameter. The compression applied to each tile. Defaults to Zoo::Codec::ZERO_RUNS.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if:
+ *          - The codec was not compiled in.
+ *          - The file cannot be opened.
+ *          - The file cannot be written.
+ */
+void Zoo::save_snapshot(std::string path, const Grid &grid, const Rule &rule, long long generation, Codec codec) {
+    save_snapshot(path, BitGrid(grid), rule, generation, codec);
 }
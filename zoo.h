@@ -10,6 +10,10 @@
  */
 #pragma once
 #include "grid.h"
+#include "bitgrid.h"
+#include "hashlife.h"
+#include "rule.h"
+#include "sparse_world.h"
 
 // Add the minimal number of includes you need in order to declare the namespace.
 // #include ...
@@ -29,6 +33,30 @@ namespace Zoo {
     Grid load_ascii(std::string path);
     void save_ascii(std::string path, Grid grid);
 
+    Grid load_rle(std::string path);
+    Grid load_rle(std::string path, Rule &rule);
+    void save_rle(std::string path, const Grid &grid, const Rule &rule = Rule());
+
+    HashLife load_macrocell(std::string path);
+    HashLife load_macrocell(std::string path, Rule &rule);
+    SparseWorld load_macrocell_sparse(std::string path, Rule &rule);
+    void save_macrocell(std::string path, const HashLife &life);
+    void save_macrocell(std::string path, const Grid &grid, const Rule &rule = Rule());
+
+    /**
+     * The compression applied to each tile of a v2 binary snapshot, see Zoo::save_snapshot.
+     */
+    enum class Codec : unsigned char { NONE = 0, ZERO_RUNS = 1, LZ4 = 2, ZSTD = 3 };
+
     Grid load_binary(std::string path);
-    void save_binary(std::string path, Grid grid);
+    Grid load_binary(std::string path, Rule &rule, long long &generation);
+    BitGrid load_binary_packed(std::string path);
+    BitGrid load_binary_packed(std::string path, Rule &rule, long long &generation);
+    Grid load_region(std::string path, int x0, int y0, int x1, int y1);
+    void save_binary(std::string path, const Grid &grid);
+    void save_binary(std::string path, const BitGrid &bits);
+    void save_snapshot(std::string path, const Grid &grid, const Rule &rule = Rule(),
+                       long long generation = 0, Codec codec = Codec::ZERO_RUNS);
+    void save_snapshot(std::string path, const BitGrid &bits, const Rule &rule = Rule(),
+                       long long generation = 0, Codec codec = Codec::ZERO_RUNS);
 };
\ No newline at end of file